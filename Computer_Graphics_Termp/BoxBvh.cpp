@@ -0,0 +1,505 @@
+#include "BoxBvh.h"
+#include "Map.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    const int BVH_LEAF_SIZE = 4;    //  ϳ  ִ ڽ 
+    const int BVH_STACK_SIZE = 64;  // ȸ   (߾Ӱ ̶ ̰ log2(n)   )
+
+    void BoxBounds(const Box& b, glm::vec3& minB, glm::vec3& maxB)
+    {
+        glm::vec3 half = b.size * 0.5f;
+        minB = b.pos - half;
+        maxB = b.pos + half;
+    }
+}
+
+const int BoxBvh::MAX_PACKET;
+
+bool IntersectBoxSlab(
+    const glm::vec3& minB,
+    const glm::vec3& maxB,
+    const glm::vec3& origin,
+    const glm::vec3& dir,
+    float maxDist,
+    float& tHit,
+    int& faceIndex)
+{
+    float tmin = 0.0f;
+    float tmax = maxDist;
+
+    int hitFace = -1;
+
+    // X  浹 Ǵ
+    if (fabs(dir.x) > 1e-6f)
+    {
+        float tx1 = (minB.x - origin.x) / dir.x;
+        float tx2 = (maxB.x - origin.x) / dir.x;
+        if (tx1 > tx2) std::swap(tx1, tx2);
+
+        float old = tmin;
+        tmin = std::max(tmin, tx1);
+        tmax = std::min(tmax, tx2);
+
+        if (tmin != old)
+            hitFace = (dir.x > 0) ? 2 : 3;  // -X = 2, +X = 3
+
+        if (tmin > tmax) return false;
+    }
+    else
+    {
+        if (origin.x < minB.x || origin.x > maxB.x)
+            return false;
+    }
+
+    // Y
+    if (fabs(dir.y) > 1e-6f)
+    {
+        float ty1 = (minB.y - origin.y) / dir.y;
+        float ty2 = (maxB.y - origin.y) / dir.y;
+        if (ty1 > ty2) std::swap(ty1, ty2);
+
+        float old = tmin;
+        tmin = std::max(tmin, ty1);
+        tmax = std::min(tmax, ty2);
+
+        if (tmin != old)
+            hitFace = (dir.y > 0) ? 4 : 5;  // -Y = 4, +Y = 5
+
+        if (tmin > tmax) return false;
+    }
+    else
+    {
+        if (origin.y < minB.y || origin.y > maxB.y)
+            return false;
+    }
+
+    // Z
+    if (fabs(dir.z) > 1e-6f)
+    {
+        float tz1 = (minB.z - origin.z) / dir.z;
+        float tz2 = (maxB.z - origin.z) / dir.z;
+        if (tz1 > tz2) std::swap(tz1, tz2);
+
+        float old = tmin;
+        tmin = std::max(tmin, tz1);
+        tmax = std::min(tmax, tz2);
+
+        if (tmin != old)
+            hitFace = (dir.z > 0) ? 0 : 1;  // -Z = 0, +Z = 1
+
+        if (tmin > tmax) return false;
+    }
+    else
+    {
+        if (origin.z < minB.z || origin.z > maxB.z)
+            return false;
+    }
+
+    if (tmin < 0.0f || tmin > maxDist)
+        return false;
+
+    tHit = tmin;
+    faceIndex = hitFace;
+    return true;
+}
+
+void BoxBvh::Build(const std::vector<Box>& boxes)
+{
+    nodes.clear();
+    primIndices.clear();
+
+    if (boxes.empty())
+        return;
+
+    std::vector<glm::vec3> centers(boxes.size());
+    primIndices.resize(boxes.size());
+    for (int i = 0; i < (int)boxes.size(); i++)
+    {
+        centers[i] = boxes[i].pos;
+        primIndices[i] = i;
+    }
+
+    //   ִ 2n - 1  ̸ Ƶθ Subdivide ߿ Ҵ  Ͼ
+    nodes.reserve(boxes.size() * 2);
+
+    Node root;
+    root.leftFirst = 0;
+    root.count = (int)boxes.size();
+    nodes.push_back(root);
+
+    Subdivide(0, centers);
+    Refit(boxes);
+}
+
+void BoxBvh::Subdivide(int nodeIndex, const std::vector<glm::vec3>& centers)
+{
+    int first = nodes[nodeIndex].leftFirst;
+    int count = nodes[nodeIndex].count;
+
+    if (count <= BVH_LEAF_SIZE)
+        return;
+
+    // ߽     ݾ 
+    glm::vec3 cmin = centers[primIndices[first]];
+    glm::vec3 cmax = cmin;
+    for (int i = first + 1; i < first + count; i++)
+    {
+        cmin = glm::min(cmin, centers[primIndices[i]]);
+        cmax = glm::max(cmax, centers[primIndices[i]]);
+    }
+
+    glm::vec3 extent = cmax - cmin;
+    int axis = 0;
+    if (extent.y > extent.x) axis = 1;
+    if (extent.z > extent[axis]) axis = 2;
+
+    int mid = first + count / 2;
+    std::nth_element(
+        primIndices.begin() + first,
+        primIndices.begin() + mid,
+        primIndices.begin() + first + count,
+        [&](int a, int b) { return centers[a][axis] < centers[b][axis]; });
+
+    int leftIndex = (int)nodes.size();
+
+    Node left;
+    left.leftFirst = first;
+    left.count = mid - first;
+
+    Node right;
+    right.leftFirst = mid;
+    right.count = first + count - mid;
+
+    nodes.push_back(left);
+    nodes.push_back(right);
+
+    nodes[nodeIndex].leftFirst = leftIndex;
+    nodes[nodeIndex].count = 0;
+
+    Subdivide(leftIndex, centers);
+    Subdivide(leftIndex + 1, centers);
+}
+
+void BoxBvh::UpdateBounds(int nodeIndex, const std::vector<Box>& boxes)
+{
+    Node& node = nodes[nodeIndex];
+
+    if (node.count > 0)
+    {
+        BoxBounds(boxes[primIndices[node.leftFirst]], node.bmin, node.bmax);
+        for (int i = node.leftFirst + 1; i < node.leftFirst + node.count; i++)
+        {
+            glm::vec3 minB, maxB;
+            BoxBounds(boxes[primIndices[i]], minB, maxB);
+            node.bmin = glm::min(node.bmin, minB);
+            node.bmax = glm::max(node.bmax, maxB);
+        }
+    }
+    else
+    {
+        const Node& l = nodes[node.leftFirst];
+        const Node& r = nodes[node.leftFirst + 1];
+        node.bmin = glm::min(l.bmin, r.bmin);
+        node.bmax = glm::max(l.bmax, r.bmax);
+    }
+}
+
+void BoxBvh::Refit(const std::vector<Box>& boxes)
+{
+    // ڽ ׻ θ𺸴 ڿ  ־ ڿ  Ʒ ->   
+    for (int i = (int)nodes.size() - 1; i >= 0; i--)
+    {
+        UpdateBounds(i, boxes);
+    }
+}
+
+bool BoxBvh::Raycast(
+    const glm::vec3& origin,
+    const glm::vec3& dir,
+    const std::vector<Box>& boxes,
+    float maxDist,
+    float& outT,
+    int& outBoxIndex,
+    int& outFaceIndex) const
+{
+    if (nodes.empty())
+        return false;
+
+    bool hit = false;
+    float closestT = maxDist;
+    int bestBox = -1;
+    int bestFace = -1;
+
+    int stack[BVH_STACK_SIZE];
+    int sp = 0;
+    stack[sp++] = 0;
+
+    while (sp > 0)
+    {
+        const Node& node = nodes[stack[--sp]];
+
+        float tNode;
+        int unusedFace;
+        if (!IntersectBoxSlab(node.bmin, node.bmax, origin, dir, maxDist, tNode, unusedFace))
+            continue;
+
+        //  Ÿ ε   ڽ    ==  ڸ 
+        if (tNode > closestT)
+            continue;
+
+        if (node.count > 0)
+        {
+            for (int i = node.leftFirst; i < node.leftFirst + node.count; i++)
+            {
+                int bi = primIndices[i];
+
+                glm::vec3 minB, maxB;
+                BoxBounds(boxes[bi], minB, maxB);
+
+                float tHit;
+                int hitFace;
+                if (!IntersectBoxSlab(minB, maxB, origin, dir, maxDist, tHit, hitFace))
+                    continue;
+
+                if (tHit < closestT || (hit && tHit == closestT && bi < bestBox))
+                {
+                    closestT = tHit;
+                    hit = true;
+                    bestBox = bi;
+                    bestFace = hitFace;
+                }
+            }
+        }
+        else
+        {
+            //  ڽ    ʺ push
+            int l = node.leftFirst;
+            int r = node.leftFirst + 1;
+            const Node& ln = nodes[l];
+            const Node& rn = nodes[r];
+            glm::vec3 d = (rn.bmin + rn.bmax) - (ln.bmin + ln.bmax);
+            float axisDir = d.x * dir.x + d.y * dir.y + d.z * dir.z;
+
+            if (axisDir >= 0.0f)
+            {
+                stack[sp++] = r;
+                stack[sp++] = l;
+            }
+            else
+            {
+                stack[sp++] = l;
+                stack[sp++] = r;
+            }
+        }
+    }
+
+    if (!hit) return false;
+
+    outT = closestT;
+    outBoxIndex = bestBox;
+    outFaceIndex = bestFace;
+    return true;
+}
+
+namespace
+{
+    // Ŷ  ึ [lo, hi]   
+    struct PacketBounds
+    {
+        glm::vec3 origin;
+        float dLo[3];
+        float dHi[3];
+        bool  usable[3];    //  ̰  ȣ̰  ƴϾ    
+        bool  parallel[3];  //  ̰  ࿡ 
+    };
+
+    // Ŷ   ̵  AABB  maxT ȿ  ߸ true
+    // n / d  d ȣ  d    (ݿø )    
+    bool PacketMisses(const PacketBounds& pb, const glm::vec3& minB, const glm::vec3& maxB, float maxT)
+    {
+        float enterMax = 0.0f;
+        float exitMin = maxT;
+
+        for (int a = 0; a < 3; a++)
+        {
+            float n1 = minB[a] - pb.origin[a];
+            float n2 = maxB[a] - pb.origin[a];
+
+            if (pb.usable[a])
+            {
+                float t0 = n1 / pb.dLo[a];
+                float t1 = n1 / pb.dHi[a];
+                float t2 = n2 / pb.dLo[a];
+                float t3 = n2 / pb.dHi[a];
+
+                float lo = std::min(std::min(t0, t1), std::min(t2, t3));
+                float hi = std::max(std::max(t0, t1), std::max(t2, t3));
+
+                enterMax = std::max(enterMax, lo);
+                exitMin = std::min(exitMin, hi);
+            }
+            else if (pb.parallel[a])
+            {
+                if (pb.origin[a] < minB[a] || pb.origin[a] > maxB[a])
+                    return true;
+            }
+        }
+
+        return enterMax > exitMin;
+    }
+}
+
+void BoxBvh::RaycastPacket(
+    const glm::vec3& origin,
+    const glm::vec3* dirs,
+    int count,
+    const std::vector<Box>& boxes,
+    float maxDist,
+    bool* outHit,
+    float* outT,
+    int* outBoxIndex,
+    int* outFaceIndex) const
+{
+    float closestT[MAX_PACKET];
+    int bestBox[MAX_PACKET];
+    int bestFace[MAX_PACKET];
+    bool hit[MAX_PACKET];
+
+    for (int r = 0; r < count; r++)
+    {
+        closestT[r] = maxDist;
+        bestBox[r] = -1;
+        bestFace[r] = -1;
+        hit[r] = false;
+    }
+
+    PacketBounds pb;
+    pb.origin = origin;
+    for (int a = 0; a < 3; a++)
+    {
+        pb.dLo[a] = dirs[0][a];
+        pb.dHi[a] = dirs[0][a];
+        for (int r = 1; r < count; r++)
+        {
+            pb.dLo[a] = std::min(pb.dLo[a], dirs[r][a]);
+            pb.dHi[a] = std::max(pb.dHi[a], dirs[r][a]);
+        }
+
+        pb.usable[a] = (pb.dLo[a] > 1e-6f) || (pb.dHi[a] < -1e-6f);
+        pb.parallel[a] = (fabs(pb.dLo[a]) <= 1e-6f) && (fabs(pb.dHi[a]) <= 1e-6f);
+    }
+
+    if (!nodes.empty() && count > 0)
+    {
+        int stack[BVH_STACK_SIZE];
+        int sp = 0;
+        stack[sp++] = 0;
+
+        while (sp > 0)
+        {
+            const Node& node = nodes[stack[--sp]];
+
+            //    ̰  maxDist,       Ÿ  
+            float farthest = 0.0f;
+            for (int r = 0; r < count; r++)
+                farthest = std::max(farthest, closestT[r]);
+
+            if (PacketMisses(pb, node.bmin, node.bmax, farthest))
+                continue;
+
+            if (node.count > 0)
+            {
+                for (int i = node.leftFirst; i < node.leftFirst + node.count; i++)
+                {
+                    int bi = primIndices[i];
+
+                    glm::vec3 minB, maxB;
+                    BoxBounds(boxes[bi], minB, maxB);
+
+                    // ڽ   ø (ڽ ǥ   а  ü )
+                    if (PacketMisses(pb, minB, maxB, farthest))
+                        continue;
+
+                    for (int r = 0; r < count; r++)
+                    {
+                        float tHit;
+                        int hitFace;
+                        if (!IntersectBoxSlab(minB, maxB, origin, dirs[r], maxDist, tHit, hitFace))
+                            continue;
+
+                        if (tHit < closestT[r] || (hit[r] && tHit == closestT[r] && bi < bestBox[r]))
+                        {
+                            closestT[r] = tHit;
+                            hit[r] = true;
+                            bestBox[r] = bi;
+                            bestFace[r] = hitFace;
+                        }
+                    }
+                }
+            }
+            else
+            {
+                stack[sp++] = node.leftFirst + 1;
+                stack[sp++] = node.leftFirst;
+            }
+        }
+    }
+
+    for (int r = 0; r < count; r++)
+    {
+        outHit[r] = hit[r];
+        outT[r] = closestT[r];
+        outBoxIndex[r] = bestBox[r];
+        outFaceIndex[r] = bestFace[r];
+    }
+}
+
+bool BoxBvh::RaycastAny(
+    const glm::vec3& origin,
+    const glm::vec3& dir,
+    const std::vector<Box>& boxes,
+    float maxDist) const
+{
+    if (nodes.empty())
+        return false;
+
+    int stack[BVH_STACK_SIZE];
+    int sp = 0;
+    stack[sp++] = 0;
+
+    while (sp > 0)
+    {
+        const Node& node = nodes[stack[--sp]];
+
+        float tNode;
+        int unusedFace;
+        if (!IntersectBoxSlab(node.bmin, node.bmax, origin, dir, maxDist, tNode, unusedFace))
+            continue;
+
+        if (node.count > 0)
+        {
+            for (int i = node.leftFirst; i < node.leftFirst + node.count; i++)
+            {
+                glm::vec3 minB, maxB;
+                BoxBounds(boxes[primIndices[i]], minB, maxB);
+
+                float tHit;
+                int hitFace;
+                // Ʈ  maxDist   ģ    ɷ ħ
+                if (IntersectBoxSlab(minB, maxB, origin, dir, maxDist, tHit, hitFace) && tHit < maxDist)
+                    return true;
+            }
+        }
+        else
+        {
+            stack[sp++] = node.leftFirst + 1;
+            stack[sp++] = node.leftFirst;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <vector>
+#include <gl/glm/glm.hpp>
+
+struct Box;
+
+// ڽ ϳ   ׽Ʈ (Ʈ / BVH   Լ   Ȱ )
+//  tHit  faceIndex(0:-Z 1:+Z 2:-X 3:+X 4:-Y 5:+Y)  ä true
+bool IntersectBoxSlab(
+    const glm::vec3& minB,
+    const glm::vec3& maxB,
+    const glm::vec3& origin,
+    const glm::vec3& dir,
+    float maxDist,
+    float& tHit,
+    int& faceIndex
+);
+
+// Map  Box    BVH
+//  ڽ ε  ְ  ǥ   Ѱִ boxes  
+class BoxBvh
+{
+public:
+    // boxes ü Ʈ   (ڽ  ٲ )
+    void Build(const std::vector<Box>& boxes);
+
+    // Ʈ  ״ ΰ  AABB  ٽ  ( / Űе / ɾ ڽ  )
+    void Refit(const std::vector<Box>& boxes);
+
+    bool IsBuilt() const
+    {
+        return !nodes.empty();
+    }
+
+    //   ڽ ã.  Ÿ ε  ڽ  (Ʈ ȸ )
+    bool Raycast(
+        const glm::vec3& origin,
+        const glm::vec3& dir,
+        const std::vector<Box>& boxes,
+        float maxDist,
+        float& outT,
+        int& outBoxIndex,
+        int& outFaceIndex
+    ) const;
+
+    //  origin     (ִ MAX_PACKET)   ȸ
+    // Ŷ    / ڽ  ɷ,  ڽ ̺ Ȯ ˻ؼ
+    //  ϳ Raycast  Ͱ   
+    static const int MAX_PACKET = 16;
+
+    void RaycastPacket(
+        const glm::vec3& origin,
+        const glm::vec3* dirs,
+        int count,
+        const std::vector<Box>& boxes,
+        float maxDist,
+        bool* outHit,
+        float* outT,
+        int* outBoxIndex,
+        int* outFaceIndex
+    ) const;
+
+    // maxDist ȿ   ٷ true ( θ ʿ )
+    bool RaycastAny(
+        const glm::vec3& origin,
+        const glm::vec3& dir,
+        const std::vector<Box>& boxes,
+        float maxDist
+    ) const;
+
+private:
+    struct Node
+    {
+        glm::vec3 bmin;
+        glm::vec3 bmax;
+        int leftFirst;  //  primIndices  ġ, ƴϸ  ڽ  ( +1)
+        int count;      //   ڽ ,   0
+    };
+
+    std::vector<Node> nodes;
+    std::vector<int>  primIndices;
+
+    void Subdivide(int nodeIndex, const std::vector<glm::vec3>& centers);
+    void UpdateBounds(int nodeIndex, const std::vector<Box>& boxes);
+};
@@ -0,0 +1,191 @@
+#include "BoxInstances.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include "Map.h"
+#include "RevealMask.h"
+
+namespace
+{
+    //  ϳ faceFlags Ʈ
+    const std::uint32_t FACE_VISIBLE = 1;
+    const std::uint32_t FACE_HAS_TEX = 2;
+    const std::uint32_t FACE_ROT = 4;
+    const std::uint32_t FACE_FLIP_X = 8;
+
+    // 鸶 8Ʈ  ĭ   ( 0~3  [0],  4~5  [1])
+    void PackByte(std::uint32_t packed[2], int face, std::uint32_t value)
+    {
+        packed[face / 4] |= (value & 0xFF) << ((face % 4) * 8);
+    }
+}
+
+BoxInstanceBuffer::~BoxInstanceBuffer()
+{
+    if (vbo != 0)
+        glDeleteBuffers(1, &vbo);
+}
+
+void BoxInstanceBuffer::Init(GLuint cubeVao)
+{
+    vao = cubeVao;
+
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+    //  ־ 0 ڵ   ְ
+    BoxInstance empty = {};
+    capacity = 1;
+    glBufferData(GL_ARRAY_BUFFER, sizeof(BoxInstance), &empty, GL_DYNAMIC_DRAW);
+
+    glBindVertexArray(vao);
+
+    const GLsizei stride = sizeof(BoxInstance);
+
+    // aInstPos / aInstSize / aInstColor
+    glEnableVertexAttribArray(4);
+    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(BoxInstance, pos));
+    glEnableVertexAttribArray(5);
+    glVertexAttribPointer(5, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(BoxInstance, size));
+    glEnableVertexAttribArray(6);
+    glVertexAttribPointer(6, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(BoxInstance, color));
+
+    //  Ӽ float  ٲ  Ǵϱ IPointer
+    glEnableVertexAttribArray(7);
+    glVertexAttribIPointer(7, 1, GL_UNSIGNED_INT, stride, (void*)offsetof(BoxInstance, faceFlags));
+    glEnableVertexAttribArray(8);
+    glVertexAttribIPointer(8, 2, GL_UNSIGNED_INT, stride, (void*)offsetof(BoxInstance, revealLayers));
+    glEnableVertexAttribArray(9);
+    glVertexAttribIPointer(9, 2, GL_UNSIGNED_INT, stride, (void*)offsetof(BoxInstance, materials));
+    glEnableVertexAttribArray(10);
+    glVertexAttribIPointer(10, 2, GL_UNSIGNED_INT, stride, (void*)offsetof(BoxInstance, texLayers));
+
+    for (GLuint attr = 4; attr <= 10; attr++)
+        glVertexAttribDivisor(attr, 1);
+
+    glBindVertexArray(0);
+}
+
+std::uint32_t BoxInstanceBuffer::FindMaterial(GLuint revealPage)
+{
+    for (std::size_t m = 1; m < materials.size(); m++)
+    {
+        if (materials[m] == revealPage)
+            return (std::uint32_t)m;
+    }
+
+    //  ʹ  ؽó   ׸
+    if ((int)materials.size() >= MAX_MATERIALS)
+        return 0;
+
+    materials.push_back(revealPage);
+    return (std::uint32_t)(materials.size() - 1);
+}
+
+BoxInstance BoxInstanceBuffer::MakeInstance(const Box& b, int boxIndex, const RevealMaskPages& revealPages)
+{
+    BoxInstance inst = {};
+    inst.pos = b.pos;
+    inst.size = b.size;
+    inst.color = b.color;
+
+    for (int face = 0; face < 6; face++)
+    {
+        if (!(b.visibleFaces & (1 << face)))
+            continue;
+
+        std::uint32_t flags = FACE_VISIBLE;
+        if (b.texRot[face] == 1)
+            flags |= FACE_ROT;
+        if (b.texFlipX[face])
+            flags |= FACE_FLIP_X;
+
+        if (b.hasTex[face])
+        {
+            flags |= FACE_HAS_TEX;
+
+            //   ĥ    ؽó
+            int slot = revealPages.GetFaceSlot(boxIndex, face);
+            PackByte(inst.revealLayers, face, (std::uint32_t)RevealMaskPages::LayerOf(slot));
+            PackByte(inst.materials, face, FindMaterial(revealPages.GetSlotTexture(slot)));
+            PackByte(inst.texLayers, face, (std::uint32_t)b.texLayer[face]);
+        }
+
+        inst.faceFlags |= flags << (face * 4);
+    }
+
+    return inst;
+}
+
+void BoxInstanceBuffer::Update(const std::vector<Box>& boxes, int first, int count, const RevealMaskPages& revealPages)
+{
+    //  ǥ Ź  (ؽó ִ     ż ΰ,    ٲϱ)
+    materials.clear();
+    materials.push_back(0);
+
+    // ڽ  ٲ  ڵ     ٽ ø
+    bool resized = ((int)instances.size() != count);
+    instances.resize(count);
+
+    int dirtyBegin = resized ? 0 : count;
+    int dirtyEnd = resized ? count : 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        BoxInstance inst = MakeInstance(boxes[first + i], first + i, revealPages);
+
+        // ڵ ü = {}  0 ä  Ʈ 񱳷 
+        if (std::memcmp(&inst, &instances[i], sizeof(BoxInstance)) != 0)
+        {
+            instances[i] = inst;
+            dirtyBegin = std::min(dirtyBegin, i);
+            dirtyEnd = std::max(dirtyEnd, i + 1);
+        }
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+    if (count > capacity)
+    {
+        // ۰ ڶ °   (VAO   ̸ پ ־ ٽ  ʿ )
+        capacity = count;
+        glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(BoxInstance), instances.data(), GL_DYNAMIC_DRAW);
+        return;
+    }
+
+    if (dirtyBegin < dirtyEnd)
+    {
+        glBufferSubData(GL_ARRAY_BUFFER,
+            dirtyBegin * sizeof(BoxInstance),
+            (dirtyEnd - dirtyBegin) * sizeof(BoxInstance),
+            &instances[dirtyBegin]);
+    }
+}
+
+void BoxInstanceBuffer::Draw(
+    GLint uInstancedLoc,
+    GLint uMaterialLoc
+) const
+{
+    if (instances.empty())
+        return;
+
+    glBindVertexArray(vao);
+    glUniform1i(uInstancedLoc, 1);
+
+    //  ؽó 迭 ̾  ٲ     revealMask 
+    glActiveTexture(GL_TEXTURE1);
+
+    for (std::size_t m = 0; m < materials.size(); m++)
+    {
+        if (m > 0)
+            glBindTexture(GL_TEXTURE_2D_ARRAY, materials[m]);
+
+        glUniform1i(uMaterialLoc, (GLint)m);
+        glDrawElementsInstanced(GL_TRIANGLES, 36, GL_UNSIGNED_INT, (void*)0, (GLsizei)instances.size());
+    }
+
+    glUniform1i(uInstancedLoc, 0);
+    glBindVertexArray(0);
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <gl/glew.h>
+#include <gl/glm/glm.hpp>
+
+struct Box;
+class RevealMaskPages;
+
+// ڽ ϳ = νϽ ϳ. vertex.glsl  4 ~ 10  Ӽ  (divisor 1)
+//  ȣ ť  ȣ ˾Ƴ (VAO_cube  鸶  4 gl_VertexID / 4)
+struct BoxInstance
+{
+    glm::vec3 pos;
+    glm::vec3 size;
+    glm::vec3 color;
+    std::uint32_t faceFlags;            // 鸶 4Ʈ (face * 4):  / ؽó / 180 ȸ / ¿ 
+    std::uint32_t revealLayers[2];      // 鸶 8Ʈ revealMask ̾ ([0] =  0~3, [1] =  4~5)
+    std::uint32_t materials[2];         // 鸶 8Ʈ  ȣ (0 = ؽó ),   revealLayers  
+    std::uint32_t texLayers[2];         // 鸶 8Ʈ TextureManager 迭 ̾
+};
+
+// νϽ  +  ǥ ( = revealMask ,  ؽó 迭 ̾   )
+//   glDrawElementsInstanced  ü νϽ ׸, ̴ uMaterial  ٸ  
+// ؽó    0 ̶   ׷, ؽó ִ   revealMask  ŭ  ׸
+// ڽ ̸ Update  ٲ ڵ常 ãƼ   ٽ ø
+class BoxInstanceBuffer
+{
+public:
+    //  ȣ 8Ʈ  ̸ŭ
+    static const int MAX_MATERIALS = 256;
+
+    BoxInstanceBuffer() = default;
+    ~BoxInstanceBuffer();
+
+    BoxInstanceBuffer(const BoxInstanceBuffer&) = delete;
+    BoxInstanceBuffer& operator=(const BoxInstanceBuffer&) = delete;
+
+    // vao (ť VAO)  νϽ Ӽ 
+    // νϽ Ӽ  ä ׳ glDrawElements ص 0 ڵ常 а ۴ ׻  ĭ ̻ Ƶ
+    void Init(GLuint vao);
+
+    bool IsReady() const
+    {
+        return vao != 0;
+    }
+
+    // boxes[first, first + count)  ڵ带 ٽ  ٲ  ø
+    void Update(const std::vector<Box>& boxes, int first, int count, const RevealMaskPages& revealPages);
+
+    //    ׸. view / proj /  uniform,  ؽó 迭 (0 )  ۿ ־ 
+    void Draw(
+        GLint uInstancedLoc,
+        GLint uMaterialLoc
+    ) const;
+
+private:
+
+    GLuint vao = 0;
+    GLuint vbo = 0;
+    int capacity = 0;
+
+    std::vector<BoxInstance> instances;
+    std::vector<GLuint> materials;      // revealMask  ؽó ([0]  ؽó  ̶  )
+
+    // ڽ ϳ ڵ ( ǥ  ̸ ߰)
+    BoxInstance MakeInstance(const Box& b, int boxIndex, const RevealMaskPages& revealPages);
+    std::uint32_t FindMaterial(GLuint revealPage);
+};
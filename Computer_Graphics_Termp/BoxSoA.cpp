@@ -0,0 +1,364 @@
+#include "BoxSoA.h"
+#include "BoxBvh.h"
+#include "Map.h"
+
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define BOXSOA_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#else
+#define BOXSOA_X86 0
+#endif
+
+// MSVC  /arch ̵ Ʈ   ִµ GCC / Clang  Լ Ÿ  
+#if BOXSOA_X86 && !defined(_MSC_VER)
+#define SIMD_TARGET(x) __attribute__((target(x)))
+#else
+#define SIMD_TARGET(x)
+#endif
+
+namespace
+{
+    const int SOA_PAD = 8;              // AVX   8
+    const float PARALLEL_EPS = 1e-6f;   // IntersectBoxSlab   
+
+    // ึ   ȣ  face ȣ (IntersectBoxSlab  )
+    int FaceForAxis(int axis, float d)
+    {
+        switch (axis)
+        {
+        case 0: return (d > 0) ? 2 : 3;
+        case 1: return (d > 0) ? 4 : 5;
+        default: return (d > 0) ? 0 : 1;
+        }
+    }
+
+    //   ڽ  ݿ (Ʈ  tie Ģ:    ü)
+    void MergeLanes(int base, int lanes, int mask, const float* t, const float* face,
+        bool& hit, float& closestT, int& bestBox, int& bestFace)
+    {
+        for (int k = 0; k < lanes; k++)
+        {
+            if (!(mask & (1 << k)))
+                continue;
+
+            if (t[k] < closestT)
+            {
+                closestT = t[k];
+                hit = true;
+                bestBox = base + k;
+                bestFace = (int)face[k];
+            }
+        }
+    }
+
+    bool RaycastScalar(const BoxSoA& soa, const glm::vec3& origin, const glm::vec3& dir, float maxDist,
+        float& outT, int& outBoxIndex, int& outFaceIndex)
+    {
+        bool hit = false;
+        float closestT = maxDist;
+        int bestBox = -1;
+        int bestFace = -1;
+
+        for (int i = 0; i < soa.count; i++)
+        {
+            glm::vec3 minB(soa.minX[i], soa.minY[i], soa.minZ[i]);
+            glm::vec3 maxB(soa.maxX[i], soa.maxY[i], soa.maxZ[i]);
+
+            float tHit;
+            int hitFace;
+            if (!IntersectBoxSlab(minB, maxB, origin, dir, maxDist, tHit, hitFace))
+                continue;
+
+            if (tHit < closestT)
+            {
+                closestT = tHit;
+                hit = true;
+                bestBox = i;
+                bestFace = hitFace;
+            }
+        }
+
+        if (!hit) return false;
+
+        outT = closestT;
+        outBoxIndex = bestBox;
+        outFaceIndex = bestFace;
+        return true;
+    }
+
+#if BOXSOA_X86
+    // min / max   std::max(tmin, t) / std::min(tmax, t)      
+    // (_mm_max_ps(a, b) = a > b ? a : b)
+
+    SIMD_TARGET("sse4.1")
+    bool RaycastSse41(const BoxSoA& soa, const glm::vec3& origin, const glm::vec3& dir, float maxDist,
+        float& outT, int& outBoxIndex, int& outFaceIndex)
+    {
+        const float* mins[3] = { soa.minX.data(), soa.minY.data(), soa.minZ.data() };
+        const float* maxs[3] = { soa.maxX.data(), soa.maxY.data(), soa.maxZ.data() };
+
+        bool hit = false;
+        float closestT = maxDist;
+        int bestBox = -1;
+        int bestFace = -1;
+
+        const __m128 vMaxDist = _mm_set1_ps(maxDist);
+        const __m128 laneIdx = _mm_setr_ps(0, 1, 2, 3);
+
+        alignas(16) float tOut[4];
+        alignas(16) float faceOut[4];
+
+        for (int base = 0; base < soa.count; base += 4)
+        {
+            __m128 tmin = _mm_setzero_ps();
+            __m128 tmax = vMaxDist;
+            __m128 face = _mm_set1_ps(-1.0f);
+            __m128 valid = _mm_cmplt_ps(laneIdx, _mm_set1_ps((float)(soa.count - base)));
+
+            for (int a = 0; a < 3; a++)
+            {
+                __m128 bmin = _mm_loadu_ps(mins[a] + base);
+                __m128 bmax = _mm_loadu_ps(maxs[a] + base);
+                __m128 o = _mm_set1_ps(origin[a]);
+
+                if (std::fabs(dir[a]) > PARALLEL_EPS)
+                {
+                    __m128 d = _mm_set1_ps(dir[a]);
+                    __m128 t1 = _mm_div_ps(_mm_sub_ps(bmin, o), d);
+                    __m128 t2 = _mm_div_ps(_mm_sub_ps(bmax, o), d);
+                    __m128 lo = _mm_min_ps(t2, t1);
+                    __m128 hi = _mm_max_ps(t1, t2);
+
+                    __m128 newMin = _mm_max_ps(lo, tmin);
+                    __m128 changed = _mm_cmpneq_ps(newMin, tmin);
+                    face = _mm_blendv_ps(face, _mm_set1_ps((float)FaceForAxis(a, dir[a])), changed);
+
+                    tmin = newMin;
+                    tmax = _mm_min_ps(hi, tmax);
+                    valid = _mm_and_ps(valid, _mm_cmple_ps(tmin, tmax));
+                }
+                else
+                {
+                    // ̸   ȿ ־ 
+                    valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpge_ps(o, bmin), _mm_cmple_ps(o, bmax)));
+                }
+            }
+
+            valid = _mm_and_ps(valid, _mm_cmple_ps(tmin, vMaxDist));
+            valid = _mm_and_ps(valid, _mm_cmplt_ps(tmin, _mm_set1_ps(closestT)));
+
+            int mask = _mm_movemask_ps(valid);
+            if (mask == 0)
+                continue;
+
+            _mm_store_ps(tOut, tmin);
+            _mm_store_ps(faceOut, face);
+            MergeLanes(base, 4, mask, tOut, faceOut, hit, closestT, bestBox, bestFace);
+        }
+
+        if (!hit) return false;
+
+        outT = closestT;
+        outBoxIndex = bestBox;
+        outFaceIndex = bestFace;
+        return true;
+    }
+
+    SIMD_TARGET("avx")
+    bool RaycastAvx(const BoxSoA& soa, const glm::vec3& origin, const glm::vec3& dir, float maxDist,
+        float& outT, int& outBoxIndex, int& outFaceIndex)
+    {
+        const float* mins[3] = { soa.minX.data(), soa.minY.data(), soa.minZ.data() };
+        const float* maxs[3] = { soa.maxX.data(), soa.maxY.data(), soa.maxZ.data() };
+
+        bool hit = false;
+        float closestT = maxDist;
+        int bestBox = -1;
+        int bestFace = -1;
+
+        const __m256 vMaxDist = _mm256_set1_ps(maxDist);
+        const __m256 laneIdx = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+
+        alignas(32) float tOut[8];
+        alignas(32) float faceOut[8];
+
+        for (int base = 0; base < soa.count; base += 8)
+        {
+            __m256 tmin = _mm256_setzero_ps();
+            __m256 tmax = vMaxDist;
+            __m256 face = _mm256_set1_ps(-1.0f);
+            __m256 valid = _mm256_cmp_ps(laneIdx, _mm256_set1_ps((float)(soa.count - base)), _CMP_LT_OQ);
+
+            for (int a = 0; a < 3; a++)
+            {
+                __m256 bmin = _mm256_loadu_ps(mins[a] + base);
+                __m256 bmax = _mm256_loadu_ps(maxs[a] + base);
+                __m256 o = _mm256_set1_ps(origin[a]);
+
+                if (std::fabs(dir[a]) > PARALLEL_EPS)
+                {
+                    __m256 d = _mm256_set1_ps(dir[a]);
+                    __m256 t1 = _mm256_div_ps(_mm256_sub_ps(bmin, o), d);
+                    __m256 t2 = _mm256_div_ps(_mm256_sub_ps(bmax, o), d);
+                    __m256 lo = _mm256_min_ps(t2, t1);
+                    __m256 hi = _mm256_max_ps(t1, t2);
+
+                    __m256 newMin = _mm256_max_ps(lo, tmin);
+                    __m256 changed = _mm256_cmp_ps(newMin, tmin, _CMP_NEQ_UQ);
+                    face = _mm256_blendv_ps(face, _mm256_set1_ps((float)FaceForAxis(a, dir[a])), changed);
+
+                    tmin = newMin;
+                    tmax = _mm256_min_ps(hi, tmax);
+                    valid = _mm256_and_ps(valid, _mm256_cmp_ps(tmin, tmax, _CMP_LE_OQ));
+                }
+                else
+                {
+                    valid = _mm256_and_ps(valid, _mm256_and_ps(
+                        _mm256_cmp_ps(o, bmin, _CMP_GE_OQ),
+                        _mm256_cmp_ps(o, bmax, _CMP_LE_OQ)));
+                }
+            }
+
+            valid = _mm256_and_ps(valid, _mm256_cmp_ps(tmin, vMaxDist, _CMP_LE_OQ));
+            valid = _mm256_and_ps(valid, _mm256_cmp_ps(tmin, _mm256_set1_ps(closestT), _CMP_LT_OQ));
+
+            int mask = _mm256_movemask_ps(valid);
+            if (mask == 0)
+                continue;
+
+            _mm256_store_ps(tOut, tmin);
+            _mm256_store_ps(faceOut, face);
+            MergeLanes(base, 8, mask, tOut, faceOut, hit, closestT, bestBox, bestFace);
+        }
+
+        if (!hit) return false;
+
+        outT = closestT;
+        outBoxIndex = bestBox;
+        outFaceIndex = bestFace;
+        return true;
+    }
+
+    void Cpuid(int leaf, int sub, int regs[4])
+    {
+#if defined(_MSC_VER)
+        __cpuidex(regs, leaf, sub);
+#else
+        unsigned int a, b, c, d;
+        __cpuid_count(leaf, sub, a, b, c, d);
+        regs[0] = (int)a; regs[1] = (int)b; regs[2] = (int)c; regs[3] = (int)d;
+#endif
+    }
+
+    unsigned long long ReadXcr0()
+    {
+#if defined(_MSC_VER)
+        return _xgetbv(0);
+#else
+        unsigned int lo, hi;
+        __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+        return ((unsigned long long)hi << 32) | lo;
+#endif
+    }
+#endif
+}
+
+SimdLevel DetectSimdLevel()
+{
+#if BOXSOA_X86
+    int regs[4];
+    Cpuid(0, 0, regs);
+    if (regs[0] < 1)
+        return SimdLevel::Scalar;
+
+    Cpuid(1, 0, regs);
+    bool sse41 = (regs[2] & (1 << 19)) != 0;
+    bool osxsave = (regs[2] & (1 << 27)) != 0;
+    bool avx = (regs[2] & (1 << 28)) != 0;
+
+    // CPU  AVX  ص OS  YMM ͸    
+    if (avx && osxsave && (ReadXcr0() & 0x6) == 0x6)
+        return SimdLevel::Avx;
+    if (sse41)
+        return SimdLevel::Sse41;
+#endif
+    return SimdLevel::Scalar;
+}
+
+const char* SimdLevelName(SimdLevel level)
+{
+    switch (level)
+    {
+    case SimdLevel::Avx:   return "AVX";
+    case SimdLevel::Sse41: return "SSE4.1";
+    default:               return "Scalar";
+    }
+}
+
+void BoxSoA::Build(const std::vector<Box>& boxes)
+{
+    count = (int)boxes.size();
+
+    // κ SIMD ε尡 迭    8  е (е  Ŀο ũ )
+    size_t padded = ((boxes.size() + SOA_PAD - 1) / SOA_PAD) * SOA_PAD;
+
+    minX.assign(padded, 0.0f); minY.assign(padded, 0.0f); minZ.assign(padded, 0.0f);
+    maxX.assign(padded, 0.0f); maxY.assign(padded, 0.0f); maxZ.assign(padded, 0.0f);
+
+    Update(boxes);
+}
+
+void BoxSoA::Update(const std::vector<Box>& boxes)
+{
+    for (int i = 0; i < count; i++)
+    {
+        const Box& b = boxes[i];
+
+        // Ʈ   ؾ Ʈ    
+        glm::vec3 half = b.size * 0.5f;
+        glm::vec3 minB = b.pos - half;
+        glm::vec3 maxB = b.pos + half;
+
+        minX[i] = minB.x; minY[i] = minB.y; minZ[i] = minB.z;
+        maxX[i] = maxB.x; maxY[i] = maxB.y; maxZ[i] = maxB.z;
+    }
+}
+
+bool RaycastBoxSoA(
+    SimdLevel level,
+    const BoxSoA& soa,
+    const glm::vec3& origin,
+    const glm::vec3& dir,
+    float maxDist,
+    float& outT,
+    int& outBoxIndex,
+    int& outFaceIndex)
+{
+#if BOXSOA_X86
+    if (level == SimdLevel::Avx)
+        return RaycastAvx(soa, origin, dir, maxDist, outT, outBoxIndex, outFaceIndex);
+    if (level == SimdLevel::Sse41)
+        return RaycastSse41(soa, origin, dir, maxDist, outT, outBoxIndex, outFaceIndex);
+#endif
+    return RaycastScalar(soa, origin, dir, maxDist, outT, outBoxIndex, outFaceIndex);
+}
+
+bool RaycastBoxSoA(
+    const BoxSoA& soa,
+    const glm::vec3& origin,
+    const glm::vec3& dir,
+    float maxDist,
+    float& outT,
+    int& outBoxIndex,
+    int& outFaceIndex)
+{
+    static const SimdLevel level = DetectSimdLevel();
+    return RaycastBoxSoA(level, soa, origin, dir, maxDist, outT, outBoxIndex, outFaceIndex);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+#include <gl/glm/glm.hpp>
+
+struct Box;
+
+//  CPU    ִ SIMD ܰ ( ߿ CPUID  Ǵ)
+enum class SimdLevel
+{
+    Scalar,
+    Sse41,  // 4
+    Avx     // 8
+};
+
+SimdLevel DetectSimdLevel();
+const char* SimdLevelName(SimdLevel level);
+
+// Box   ׽Ʈ (min / max)  Ƶ SoA 纻
+// Box  ؽó / revealMask   Ͱ  ־  ׽Ʈ  ĳø  
+// 迭 ̴ 8  еصּ SIMD   ׳ о 
+struct BoxSoA
+{
+    int count = 0;
+
+    std::vector<float> minX, minY, minZ;
+    std::vector<float> maxX, maxY, maxZ;
+
+    // ڽ  ٲ  (InitFromArray)
+    void Build(const std::vector<Box>& boxes);
+
+    // ڽ ġ / ũ⸸ ٲ 
+    void Update(const std::vector<Box>& boxes);
+};
+
+// SoA ü   ˻ؼ   ڽ ã
+// (t, ڽ, face) IntersectBoxSlab    Ʈ Ȱ
+bool RaycastBoxSoA(
+    const BoxSoA& soa,
+    const glm::vec3& origin,
+    const glm::vec3& dir,
+    float maxDist,
+    float& outT,
+    int& outBoxIndex,
+    int& outFaceIndex
+);
+
+// Ư ܰ Ŀ  ȣ ( / , CPU  ϴ ȣϴ ʿ Ȯ)
+bool RaycastBoxSoA(
+    SimdLevel level,
+    const BoxSoA& soa,
+    const glm::vec3& origin,
+    const glm::vec3& dir,
+    float maxDist,
+    float& outT,
+    int& outBoxIndex,
+    int& outFaceIndex
+);
@@ -0,0 +1,209 @@
+#include "CellVisibility.h"
+
+#include <cmath>
+
+namespace
+{
+    //  ȿ ̸   (  0~1,  𼭸 ó + )
+    const float SAMPLE_POINTS[5][2] =
+    {
+        { 0.5f,  0.5f  },
+        { 0.05f, 0.05f },
+        { 0.95f, 0.05f },
+        { 0.05f, 0.95f },
+        { 0.95f, 0.95f },
+    };
+
+    //     .    ( 30ĭ )        ĭ 
+    const int RAY_DIRECTIONS = 512;
+
+    const float PI = 3.14159265358979f;
+}
+
+void CellVisibility::Build(int w, int h, const int* data, const glm::vec2& origin, float size)
+{
+    width = w;
+    height = h;
+    gridMin = origin;
+    cellSize = size;
+
+    int cellCount = w * h;
+    wordsPerRow = (cellCount + 63) / 64;
+    visible.assign((std::size_t)cellCount * wordsPerRow, 0);
+
+    std::vector<unsigned char> solid(cellCount);
+    for (int i = 0; i < cellCount; i++)
+        solid[i] = (data[i] == 1) ? 1 : 0;
+
+    std::vector<glm::vec2> dirs(RAY_DIRECTIONS);
+    for (int k = 0; k < RAY_DIRECTIONS; k++)
+    {
+        float a = 2.0f * PI * (k + 0.5f) / RAY_DIRECTIONS;
+        dirs[k] = glm::vec2(std::cos(a), std::sin(a));
+    }
+
+    for (int z = 0; z < h; z++)
+    {
+        for (int x = 0; x < w; x++)
+        {
+            int from = z * w + x;
+
+            Mark(from, from);
+            if (solid[from])
+                continue;
+
+            for (const float* s : SAMPLE_POINTS)
+            {
+                glm::vec2 start(x + s[0], z + s[1]);
+                for (const glm::vec2& d : dirs)
+                    TraceRay(from, solid, start, d);
+            }
+        }
+    }
+
+    // ̴  ̴ϱ ʿ  ֵ  ̴ ɷ (ø   )
+    for (int a = 0; a < cellCount; a++)
+    {
+        for (int b = a + 1; b < cellCount; b++)
+        {
+            if (IsVisible(a, b) || IsVisible(b, a))
+            {
+                Mark(a, b);
+                Mark(b, a);
+            }
+        }
+    }
+
+    //   ÷̾   ī޶     ɸ  
+    // ׶   鿡 ̴  ļ 
+    static const int NEIGHBOR4[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+    for (int from = 0; from < cellCount; from++)
+    {
+        if (!solid[from])
+            continue;
+
+        std::uint64_t* bits = &visible[(std::size_t)from * wordsPerRow];
+        for (const int* n : NEIGHBOR4)
+        {
+            int nx = from % w + n[0];
+            int nz = from / w + n[1];
+            if (nx < 0 || nx >= w || nz < 0 || nz >= h || solid[nz * w + nx])
+                continue;
+
+            const std::uint64_t* other = &visible[(std::size_t)(nz * w + nx) * wordsPerRow];
+            for (int i = 0; i < wordsPerRow; i++)
+                bits[i] |= other[i];
+        }
+    }
+
+    // ̴  ̿ 8ĭ ̴ ɷ ( ̷   / 𼭸)
+    std::vector<std::uint64_t> row(wordsPerRow);
+    for (int from = 0; from < cellCount; from++)
+    {
+        std::uint64_t* bits = &visible[(std::size_t)from * wordsPerRow];
+        row.assign(bits, bits + wordsPerRow);
+
+        for (int cell = 0; cell < cellCount; cell++)
+        {
+            if (!((row[cell >> 6] >> (cell & 63)) & 1))
+                continue;
+
+            //    ۶߸  ( ʸӰ   ʰ)
+            if (solid[cell])
+                continue;
+
+            int cx = cell % w;
+            int cz = cell / w;
+            for (int dz = -1; dz <= 1; dz++)
+            {
+                for (int dx = -1; dx <= 1; dx++)
+                {
+                    int nx = cx + dx;
+                    int nz = cz + dz;
+                    if (nx < 0 || nx >= w || nz < 0 || nz >= h)
+                        continue;
+                    Mark(from, nz * w + nx);
+                }
+            }
+        }
+    }
+}
+
+void CellVisibility::TraceRay(int from, const std::vector<unsigned char>& solid, glm::vec2 start, glm::vec2 dir)
+{
+    // 2D DDA (GridIndex::Raycast   ,  )
+    int x = (int)std::floor(start.x);
+    int z = (int)std::floor(start.y);
+
+    int stepX = (dir.x > 0.0f) ? 1 : -1;
+    int stepZ = (dir.y > 0.0f) ? 1 : -1;
+
+    float tDeltaX = (dir.x != 0.0f) ? std::fabs(1.0f / dir.x) : 1e30f;
+    float tDeltaZ = (dir.y != 0.0f) ? std::fabs(1.0f / dir.y) : 1e30f;
+
+    float tMaxX = (dir.x != 0.0f) ? ((stepX > 0 ? (x + 1 - start.x) : (start.x - x)) * tDeltaX) : 1e30f;
+    float tMaxZ = (dir.y != 0.0f) ? ((stepZ > 0 ? (z + 1 - start.y) : (start.y - z)) * tDeltaZ) : 1e30f;
+
+    while (true)
+    {
+        if (tMaxX < tMaxZ)
+        {
+            x += stepX;
+            tMaxX += tDeltaX;
+        }
+        else
+        {
+            z += stepZ;
+            tMaxZ += tDeltaZ;
+        }
+
+        if (x < 0 || x >= width || z < 0 || z >= height)
+            return;
+
+        int cell = z * width + x;
+        Mark(from, cell);
+
+        if (solid[cell])
+            return;
+    }
+}
+
+int CellVisibility::CellOf(const glm::vec3& p) const
+{
+    if (!IsBuilt())
+        return -1;
+
+    int x = (int)std::floor((p.x - gridMin.x) / cellSize);
+    int z = (int)std::floor((p.z - gridMin.y) / cellSize);
+    if (x < 0 || x >= width || z < 0 || z >= height)
+        return -1;
+
+    return z * width + x;
+}
+
+bool CellVisibility::IsAnyVisible(int from, int x0, int z0, int x1, int z1) const
+{
+    if (from < 0)
+        return true;
+
+    //   (z)   Ʈ ̾ ־ 64Ʈ    
+    const std::uint64_t* row = &visible[(std::size_t)from * wordsPerRow];
+    for (int z = z0; z <= z1; z++)
+    {
+        int first = z * width + x0;
+        int last = z * width + x1;
+
+        for (int word = first >> 6; word <= (last >> 6); word++)
+        {
+            std::uint64_t bits = row[word];
+            if (word == (first >> 6))
+                bits &= ~std::uint64_t(0) << (first & 63);
+            if (word == (last >> 6))
+                bits &= ~std::uint64_t(0) >> (63 - (last & 63));
+
+            if (bits != 0)
+                return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <gl/glm/glm.hpp>
+
+// ̷ XZ   "⼭   ִ "  (PVS)  ̸ ص
+//      2D  ̸        ǥϰ,
+// ǥõ   ̿ 8ĭ ؼ 񽺵 ġ    (ġ ͺ  ׸ )
+//  õ  ־    .   ̸    (ٴ /  / õ)   
+class CellVisibility
+{
+public:
+    // w x h  (data  InitFromArray   迭, 1 = ), origin =  ּ 𼭸 (x, z)
+    void Build(int w, int h, const int* data, const glm::vec2& origin, float cellSize);
+
+    bool IsBuilt() const
+    {
+        return !visible.empty();
+    }
+
+    int GetWidth() const
+    {
+        return width;
+    }
+
+    int GetHeight() const
+    {
+        return height;
+    }
+
+    int GetCellCount() const
+    {
+        return width * height;
+    }
+
+    //  ǥ   (z * w + x).  ̸ -1
+    int CellOf(const glm::vec3& p) const;
+
+    // from  to    ִ. from  -1 ( ) ̸  ̴ ɷ
+    bool IsVisible(int from, int to) const
+    {
+        if (from < 0 || to < 0)
+            return true;
+
+        const std::uint64_t* row = &visible[(std::size_t)from * wordsPerRow];
+        return (row[to >> 6] >> (to & 63)) & 1;
+    }
+
+    // from  x0~x1, z0~z1 (  ) 簢   ϳ ̴ (  ϳ   ĥ )
+    bool IsAnyVisible(int from, int x0, int z0, int x1, int z1) const;
+
+private:
+    int width = 0;
+    int height = 0;
+    glm::vec2 gridMin = glm::vec2(0.0f);
+    float cellSize = 1.0f;
+
+    int wordsPerRow = 0;
+    std::vector<std::uint64_t> visible;     //  wordsPerRow  Ʈ
+
+    void Mark(int from, int to)
+    {
+        visible[(std::size_t)from * wordsPerRow + (to >> 6)] |= std::uint64_t(1) << (to & 63);
+    }
+
+    // (x, z)  ǥ (  Ǽ)  dir      from  ǥ
+    void TraceRay(int from, const std::vector<unsigned char>& solid, glm::vec2 start, glm::vec2 dir);
+};
@@ -0,0 +1,228 @@
+#include "GridIndex.h"
+#include "Map.h"
+
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    const float CELL_FIT_EPS = 1e-3f;   // ڽ   ´    
+    const float DDA_SLACK = 1e-3f;      //   t      ɾ ( Ÿ ڽ ġ ʰ)
+    const float PARALLEL_EPS = 1e-6f;   // IntersectBoxSlab   
+
+    bool ConsiderBox(const std::vector<Box>& boxes, int bi,
+        const glm::vec3& origin, const glm::vec3& dir, float maxDist,
+        bool& hit, float& closestT, int& bestBox, int& bestFace)
+    {
+        const Box& b = boxes[bi];
+
+        glm::vec3 half = b.size * 0.5f;
+        glm::vec3 minB = b.pos - half;
+        glm::vec3 maxB = b.pos + half;
+
+        float tHit;
+        int hitFace;
+        if (!IntersectBoxSlab(minB, maxB, origin, dir, maxDist, tHit, hitFace))
+            return false;
+
+        if (tHit < closestT || (hit && tHit == closestT && bi < bestBox))
+        {
+            closestT = tHit;
+            hit = true;
+            bestBox = bi;
+            bestFace = hitFace;
+            return true;
+        }
+        return false;
+    }
+}
+
+void GridIndex::Init(const glm::vec3& origin, const glm::vec3& size, int nx, int ny, int nz)
+{
+    gridMin = origin;
+    cellSize = size;
+    dims[0] = nx;
+    dims[1] = ny;
+    dims[2] = nz;
+
+    cells.assign(nx * ny * nz, -1);
+    overflow.clear();
+}
+
+void GridIndex::Insert(int boxIndex, const Box& b)
+{
+    glm::vec3 half = b.size * 0.5f;
+    glm::vec3 minB = b.pos - half;
+    glm::vec3 maxB = b.pos + half;
+
+    int c[3];
+    for (int a = 0; a < 3; a++)
+    {
+        c[a] = (int)std::floor((b.pos[a] - gridMin[a]) / cellSize[a]);
+        if (c[a] < 0 || c[a] >= dims[a])
+        {
+            overflow.push_back(boxIndex);
+            return;
+        }
+
+        float cellMin = gridMin[a] + c[a] * cellSize[a];
+        float cellMax = cellMin + cellSize[a];
+        if (std::fabs(minB[a] - cellMin) > CELL_FIT_EPS || std::fabs(maxB[a] - cellMax) > CELL_FIT_EPS)
+        {
+            overflow.push_back(boxIndex);
+            return;
+        }
+    }
+
+    int& slot = cells[CellIndex(c[0], c[1], c[2])];
+    if (slot >= 0)
+    {
+        overflow.push_back(boxIndex);
+        return;
+    }
+    slot = boxIndex;
+}
+
+void GridIndex::InsertOverflow(int boxIndex)
+{
+    overflow.push_back(boxIndex);
+}
+
+bool GridIndex::IsOnCellBoundary(const glm::vec3& origin, const glm::vec3& dir) const
+{
+    // ࿡  ̴     Ѿµ,
+    //       ׽Ʈ   ڽ  ¾Ҵٰ 
+    for (int a = 0; a < 3; a++)
+    {
+        if (std::fabs(dir[a]) > PARALLEL_EPS)
+            continue;
+
+        float f = (origin[a] - gridMin[a]) / cellSize[a];
+        if (std::fabs(f - std::round(f)) * cellSize[a] < CELL_FIT_EPS)
+            return true;
+    }
+    return false;
+}
+
+bool GridIndex::Raycast(
+    const glm::vec3& origin,
+    const glm::vec3& dir,
+    const std::vector<Box>& boxes,
+    float maxDist,
+    float& outT,
+    int& outBoxIndex,
+    int& outFaceIndex) const
+{
+    bool hit = false;
+    float closestT = maxDist;
+    int bestBox = -1;
+    int bestFace = -1;
+
+    for (int bi : overflow)
+    {
+        ConsiderBox(boxes, bi, origin, dir, maxDist, hit, closestT, bestBox, bestFace);
+    }
+
+    if (IsOnCellBoundary(origin, dir))
+    {
+        // 幮  ׳  ڽ  ˻
+        for (int bi : cells)
+        {
+            if (bi >= 0)
+                ConsiderBox(boxes, bi, origin, dir, maxDist, hit, closestT, bestBox, bestFace);
+        }
+    }
+    else
+    {
+        //  AABB    t
+        glm::vec3 gridMax = gridMin + cellSize * glm::vec3((float)dims[0], (float)dims[1], (float)dims[2]);
+
+        float tEnter = 0.0f;
+        float tExit = maxDist;
+        bool inside = true;
+
+        for (int a = 0; a < 3 && inside; a++)
+        {
+            if (std::fabs(dir[a]) > PARALLEL_EPS)
+            {
+                float t1 = (gridMin[a] - origin[a]) / dir[a];
+                float t2 = (gridMax[a] - origin[a]) / dir[a];
+                if (t1 > t2) std::swap(t1, t2);
+                tEnter = std::max(tEnter, t1);
+                tExit = std::min(tExit, t2);
+            }
+            else if (origin[a] < gridMin[a] || origin[a] > gridMax[a])
+            {
+                inside = false;
+            }
+        }
+
+        if (inside && tEnter <= tExit)
+        {
+            const float INF = std::numeric_limits<float>::infinity();
+
+            glm::vec3 p = origin + dir * tEnter;
+
+            int cell[3];
+            int step[3];
+            float tMax[3];
+            float tDelta[3];
+
+            for (int a = 0; a < 3; a++)
+            {
+                int c = (int)std::floor((p[a] - gridMin[a]) / cellSize[a]);
+                cell[a] = std::min(std::max(c, 0), dims[a] - 1);
+
+                if (std::fabs(dir[a]) > PARALLEL_EPS)
+                {
+                    step[a] = (dir[a] > 0.0f) ? 1 : -1;
+                    float boundary = gridMin[a] + (cell[a] + (step[a] > 0 ? 1 : 0)) * cellSize[a];
+                    tMax[a] = (boundary - origin[a]) / dir[a];
+                    tDelta[a] = cellSize[a] / std::fabs(dir[a]);
+                }
+                else
+                {
+                    step[a] = 0;
+                    tMax[a] = INF;
+                    tDelta[a] = INF;
+                }
+            }
+
+            float tCell = tEnter;
+            while (true)
+            {
+                if (tCell > tExit + DDA_SLACK)
+                    break;
+
+                // ̹ ã ͺ  ̸ 
+                if (hit && tCell > closestT + DDA_SLACK)
+                    break;
+
+                int bi = cells[CellIndex(cell[0], cell[1], cell[2])];
+                if (bi >= 0)
+                    ConsiderBox(boxes, bi, origin, dir, maxDist, hit, closestT, bestBox, bestFace);
+
+                //  谡     ĭ ̵
+                int a = 0;
+                if (tMax[1] < tMax[a]) a = 1;
+                if (tMax[2] < tMax[a]) a = 2;
+
+                if (tMax[a] == INF)
+                    break;
+
+                tCell = tMax[a];
+                cell[a] += step[a];
+                if (cell[a] < 0 || cell[a] >= dims[a])
+                    break;
+                tMax[a] += tDelta[a];
+            }
+        }
+    }
+
+    if (!hit) return false;
+
+    outT = closestT;
+    outBoxIndex = bestBox;
+    outFaceIndex = bestFace;
+    return true;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+#include <gl/glm/glm.hpp>
+
+struct Box;
+
+// InitFromArray     (x, , z)  ڽ ε ÷δ 
+//   ´ ڽ  ϳ, ( / Űе / ɾ ڽ ) overflow Ͽ 
+// ̴ 3D-DDA    湮ϴϱ   ũⰡ ƴ϶  ̿ 
+class GridIndex
+{
+public:
+    // origin =  ּ 𼭸, cellSize =   ĭ ũ, nx/ny/nz =  
+    void Init(const glm::vec3& origin, const glm::vec3& cellSize, int nx, int ny, int nz);
+
+    //    , ƴϸ (Ȥ   ̹ á) overflow  
+    void Insert(int boxIndex, const Box& b);
+
+    // ̴ ڽó    Ǵ   overflow
+    void InsertOverflow(int boxIndex);
+
+    bool IsBuilt() const
+    {
+        return !cells.empty();
+    }
+
+    const glm::vec3& GetOrigin() const
+    {
+        return gridMin;
+    }
+
+    const glm::vec3& GetCellSize() const
+    {
+        return cellSize;
+    }
+
+    int GetDim(int axis) const
+    {
+        return dims[axis];
+    }
+
+    //   ִ ڽ ε. ų  ̸ -1
+    int GetCellBox(int x, int y, int z) const
+    {
+        if (x < 0 || x >= dims[0] || y < 0 || y >= dims[1] || z < 0 || z >= dims[2])
+            return -1;
+        return cells[CellIndex(x, y, z)];
+    }
+
+    //   ڽ ã.  Ÿ ε  ڽ (Ʈ )
+    bool Raycast(
+        const glm::vec3& origin,
+        const glm::vec3& dir,
+        const std::vector<Box>& boxes,
+        float maxDist,
+        float& outT,
+        int& outBoxIndex,
+        int& outFaceIndex
+    ) const;
+
+private:
+    glm::vec3 gridMin = glm::vec3(0.0f);
+    glm::vec3 cellSize = glm::vec3(1.0f);
+    int dims[3] = { 0, 0, 0 };
+
+    std::vector<int> cells;     //  ڽ ε,   -1
+    std::vector<int> overflow;  // ڿ  ´ ڽ
+
+    int CellIndex(int x, int y, int z) const
+    {
+        return (y * dims[2] + z) * dims[0] + x;
+    }
+
+    bool IsOnCellBoundary(const glm::vec3& origin, const glm::vec3& dir) const;
+};
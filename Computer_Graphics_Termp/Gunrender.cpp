@@ -71,8 +71,8 @@ bool GunRenderer::Load(const char* path)
 
 void GunRenderer::Draw(GLuint shaderProgram,
     GLint uModelLoc,
-    GLint uViewLoc,
-    GLint uProjLoc,
+    GLint uNormalMatLoc,
+    GLint uViewProjLoc,
     GLint uColorLoc,
     const glm::mat4& view,
     const glm::mat4& proj,
@@ -96,9 +96,12 @@ void GunRenderer::Draw(GLuint shaderProgram,
     model = glm::rotate(model, glm::radians(-5.0f), glm::vec3(1, 0, 0));
     model = glm::scale(model, glm::vec3(0.003f)); //  ũ 
 
+    //   / view-proj    ⼭  
+    glm::mat3 normalMat = glm::transpose(glm::inverse(glm::mat3(model)));
+    glm::mat4 viewProj = proj * view;
     glUniformMatrix4fv(uModelLoc, 1, GL_FALSE, glm::value_ptr(model));
-    glUniformMatrix4fv(uViewLoc, 1, GL_FALSE, glm::value_ptr(view));
-    glUniformMatrix4fv(uProjLoc, 1, GL_FALSE, glm::value_ptr(proj));
+    glUniformMatrix3fv(uNormalMatLoc, 1, GL_FALSE, glm::value_ptr(normalMat));
+    glUniformMatrix4fv(uViewProjLoc, 1, GL_FALSE, glm::value_ptr(viewProj));
 
     glm::vec3 lightPos = camPos + camFront * 2.0f + camUp * 1.0f;
     glUniform3fv(glGetUniformLocation(shaderProgram, "lightPos"), 1, glm::value_ptr(lightPos));
@@ -6,11 +6,33 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <iostream>
 
 #include <gl/glm/gtc/type_ptr.hpp>
 #include <gl/glm/gtx/quaternion.hpp>
 
+// Ʈ ûũ      ĭ
+static const int CHUNK_CELLS = 2;
+
+// revealMask     (ؼ)
+static const int FAN_STAMP_RADIUS = 4;
+static const int SWEEP_STAMP_RADIUS = 6;
+
+//  :    ̴  / ҷ  Ӵ  ð /   ִ  
+static const std::chrono::seconds SAVE_INTERVAL(2);
+static const std::chrono::milliseconds LOAD_BUDGET(2);
+static const std::size_t LOAD_POINT_STEP = 4096;
+
+//   : Ӵ  ð /    ִ  (ּ COMPACT_MIN_BYTES  ħ)   踦  
+static const std::chrono::milliseconds COMPACT_BUDGET(1);
+static const std::size_t COMPACT_RATIO = 2;
+static const std::size_t COMPACT_MIN_BYTES = 1 << 20;
+
+// ĵ ٷ: Ӵ ּ   (Ŷ ϳ) /  ̵  ġ
+static const int MIN_SCAN_RAYS = BoxBvh::MAX_PACKET;
+static const float COST_SMOOTHING = 0.1f;
+
 static void ComputeFaceUV(const Box& b, int face, int texRot, const glm::vec3& hitPos, float& u, float& v)
 {
     glm::vec3 local = hitPos - b.pos;
@@ -63,51 +85,125 @@ static void ComputeFaceUV(const Box& b, int face, int texRot, const glm::vec3& h
 
 Lidar::Lidar()
     : VAO(0)
-    , VBO(0)
-    , maxPoints(1000000)
+    , points(1000000)
 {
 }
 
 Lidar::~Lidar()
 {
-    if (VBO != 0)
-    {
-        glDeleteBuffers(1, &VBO);
-    }
+    // ۾ڰ  / Ǯ         
+    StopScanWorker();
+
     if (VAO != 0)
     {
         glDeleteVertexArrays(1, &VAO);
     }
 }
 
-void Lidar::Init()
+void Lidar::Init(const Map& map)
 {
     glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
 
     glBindVertexArray(VAO);
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3) * maxPoints, nullptr, GL_DYNAMIC_DRAW);
+    // Ʈ Ŭ VBO / LOD ε ۸   VAO   (0 aPos  ⼭ )
+    points.Init();
 
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+    // ûũ =   CHUNK_CELLS x CHUNK_CELLS ĭ (̴ ü)
+    const GridIndex& grid = map.GetGrid();
+    if (grid.IsBuilt())
+    {
+        glm::vec3 cell = grid.GetCellSize();
+        int nx = (grid.GetDim(0) + CHUNK_CELLS - 1) / CHUNK_CELLS;
+        int nz = (grid.GetDim(2) + CHUNK_CELLS - 1) / CHUNK_CELLS;
+        points.SetChunkGrid(grid.GetOrigin(),
+            cell.x * CHUNK_CELLS, cell.z * CHUNK_CELLS, cell.y * grid.GetDim(1),
+            nx, nz);
+    }
 
     // normal    (0, 1, 0)  (ʹϱ   ʿ  Ʈ 븻  )
     glDisableVertexAttribArray(1);
     glVertexAttrib3f(1, 0.0f, 1.0f, 0.0f);
 
     glBindVertexArray(0);
+
+    StartScanWorker();
 }
 
-void Lidar::AddHitPoint(const glm::vec3& p)
+void Lidar::StartScanWorker()
 {
-    points.push_back(p);
+    if (scanThread.joinable())
+        return;
+
+    scanStop.store(false);
+    scanThread = std::thread(&Lidar::ScanWorkerLoop, this);
+}
 
-    if (points.size() > maxPoints)
+void Lidar::StopScanWorker()
+{
+    if (!scanThread.joinable())
+        return;
+
+    scanStop.store(true);
+    WakeScanWorker();
+    scanThread.join();
+
+    // ť    ޾ƾ   ٲ
+    ScanHitBatch batch;
+    while (scanResults.TryPop(batch))
     {
-        points.erase(points.begin(), points.begin() + maxPoints - 1);
+        pendingHits.hits.insert(pendingHits.hits.end(), batch.hits.begin(), batch.hits.end());
+        raysInFlight -= batch.rayCount;
     }
+
+    pendingHits.hits.insert(pendingHits.hits.end(), strandedBatch.hits.begin(), strandedBatch.hits.end());
+    raysInFlight -= strandedBatch.rayCount;
+    strandedBatch = ScanHitBatch();
+}
+
+void Lidar::SetScanThreads(int count)
+{
+    bool running = scanThread.joinable();
+
+    StopScanWorker();
+    scanPool.SetThreadCount(count);
+
+    if (running)
+        StartScanWorker();
+}
+
+void Lidar::AddHitPoint(const glm::vec3& p, int surface)
+{
+    if (dedupEnabled)
+    {
+        VoxelHash::Voxel& v = voxels.Get(p);
+
+        //     ִ    
+        if (v.hitCount > 0 && points.IsAlive(v.pointHandle))
+        {
+            v.hitCount++;
+            v.lastSeen = hitBatch;
+            return;
+        }
+
+        // ó ¾Ұų   Ŭ忡 з  
+        v.pointHandle = points.Push(p, pointClock, surface);
+        v.hitCount = 1;
+        v.lastSeen = hitBatch;
+
+        // з   ̸   
+        if (voxels.Size() > points.Capacity() * 2)
+            voxels.Prune([this](std::uint64_t h) { return points.IsAlive(h); });
+    }
+    else
+    {
+        //     Ϻ  
+        points.Push(p, pointClock, surface);
+    }
+
+    // ҷ ߿      ü  ϱ   
+    if (saveWriter.IsOpen() && !saveLoading)
+        unsavedPoints.push_back(p);
 }
 
 void Lidar::ScanFan(const glm::vec3& origin, const glm::vec3& front, const Map& map)
@@ -151,9 +247,15 @@ void Lidar::ScanFan(const glm::vec3& origin, const glm::vec3& front, const Map&
             dir = glm::normalize(dir);
 
             debugRays.push_back(dir);
-            ScanSingleRay(origin, dir, map);
         }
     }
+
+    ScanJob job;
+    job.snapshot = AcquireSnapshot(map);
+    job.origin = origin;
+    job.dirs = debugRays;
+    job.source = ScanHitSource::Fan;
+    SubmitScanJob(std::move(job));
 }
 
 void Lidar::ScanSingleRay(const glm::vec3& origin, const glm::vec3& dir, const Map& map)
@@ -169,146 +271,642 @@ void Lidar::ScanSingleRay(const glm::vec3& origin, const glm::vec3& dir, const M
     const float maxDist = 1000.0f;
 
     // faceIndex boxIndex   Raycast ȣ
-    if (Raycast(origin, nDir, boxes, maxDist, hit, &boxIndex, &faceIndex))
+    if (Raycast(origin, nDir, map, maxDist, hit, &boxIndex, &faceIndex))
     {
-        AddHitPoint(hit);
+        EmitHit(boxes[boxIndex], boxIndex, faceIndex, hit, ScanHitSource::Fan, pendingHits);
+    }
+}
 
-        // ȿ ڽ + face   revealMask 
-        if (boxIndex >= 0 && faceIndex >= 0)
-        {
-            const Box& b = boxes[boxIndex];
+void Lidar::EmitHit(const Box& b, int boxIndex, int faceIndex, const glm::vec3& hit, ScanHitSource source, ScanHitBatch& out) const
+{
+    ScanHit h;
+    h.pos = hit;
+    h.boxIndex = boxIndex;
+    h.faceIndex = faceIndex;
+    h.u = 0.0f;
+    h.v = 0.0f;
+    h.source = source;
+
+    // texRot  UV  (face   )
+    if (faceIndex >= 0)
+    {
+        ComputeFaceUV(b, faceIndex, b.texRot[faceIndex], hit, h.u, h.v);
+    }
 
-            float u, v;
-            // texRot  UV 
-            ComputeFaceUV(b, faceIndex, b.texRot[faceIndex], hit, u, v);
+    out.hits.push_back(h);
+}
 
-            int X = int(u * 255);
-            int Y = int(v * 255);
+std::shared_ptr<const ScanSnapshot> Lidar::AcquireSnapshot(const Map& map)
+{
+    //  ̴ ȸ Ӹ  ߰, ҿ    
+    //   ۾ڰ װɷ ϴ ϰ   ˾Ƽ Ǯ
+    if (liveSnapshot == nullptr || liveSnapshotVersion != map.GetBoundsVersion())
+    {
+        std::shared_ptr<ScanSnapshot> s = std::make_shared<ScanSnapshot>();
+        s->boxes = map.GetBoxes();
+        s->bvh = map.GetBvh();
+        s->grid = map.GetGrid();
+        s->soa = map.GetBoxSoA();
+
+        liveSnapshot = s;
+        liveSnapshotVersion = map.GetBoundsVersion();
+    }
 
-            glBindTexture(GL_TEXTURE_2D, b.revealMask[faceIndex]);
+    return liveSnapshot;
+}
 
-            const int R = 4;
-            unsigned char value = 255;
+void Lidar::WakeScanWorker()
+{
+    // ۾ڰ  Ȯϰ  ̿ ˸  ʰ mutex    ħ
+    {
+        std::lock_guard<std::mutex> lock(scanWakeMutex);
+    }
+    scanWakeCv.notify_one();
+}
 
-            for (int j = -R; j <= R; j++)
-            {
-                for (int i = -R; i <= R; i++)
-                {
-                    if (i * i + j * j > R * R) continue;
+void Lidar::SubmitScanJob(ScanJob&& job)
+{
+    // ۾ڰ  (Init ) ׳ ⼭ 
+    if (!scanThread.joinable())
+    {
+        RunScanJob(job, pendingHits);
+        return;
+    }
 
-                    int tx = X + i;
-                    int ty = Y + j;
-                    if (tx < 0 || tx > 255 || ty < 0 || ty > 255) continue;
+    raysInFlight += (int)job.dirs.size();
 
-                    glTexSubImage2D(GL_TEXTURE_2D, 0,
-                        tx, ty,
-                        1, 1,
-                        GL_RED, GL_UNSIGNED_BYTE,
-                        &value);
-                }
+    //  ѱ  ϰ    ٲ  ڿ  
+    if (overflowJobs.empty() && scanJobs.TryPush(std::move(job)))
+    {
+        WakeScanWorker();
+        return;
+    }
+
+    overflowJobs.push_back(std::move(job));
+}
+
+void Lidar::SubmitOverflowJobs()
+{
+    if (overflowJobs.empty())
+        return;
+
+    while (!overflowJobs.empty() && scanJobs.TryPush(std::move(overflowJobs.front())))
+    {
+        overflowJobs.pop_front();
+    }
+
+    WakeScanWorker();
+}
+
+void Lidar::ScanWorkerLoop()
+{
+    while (!scanStop.load())
+    {
+        ScanJob job;
+        if (!scanJobs.TryPop(job))
+        {
+            std::unique_lock<std::mutex> lock(scanWakeMutex);
+            scanWakeCv.wait(lock, [this] { return scanStop.load() || !scanJobs.Empty(); });
+            continue;
+        }
+
+        ScanHitBatch batch;
+
+        auto t0 = std::chrono::steady_clock::now();
+        RunScanJob(job, batch);
+        float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+        batch.rayCount = (int)job.dirs.size();
+        if (batch.rayCount > 0)
+        {
+            // ۾ڸ ϱ load / store  
+            float cost = traceCostPerRay.load();
+            traceCostPerRay.store(cost + (ms / batch.rayCount - cost) * COST_SMOOTHING);
+        }
+
+        // GLUT 尡 Ӹ ϱ     .    纸
+        while (!scanResults.TryPush(std::move(batch)))
+        {
+            if (scanStop.load())
+            {
+                //  ѱ  StopScanWorker  join  ޾ư
+                strandedBatch = std::move(batch);
+                return;
             }
+            std::this_thread::yield();
         }
     }
 }
 
+void Lidar::RunScanJob(const ScanJob& job, ScanHitBatch& out)
+{
+    const ScanSnapshot& snap = *job.snapshot;
 
-bool Lidar::Raycast(
-    const glm::vec3& origin,
-    const glm::vec3& dir,
-    const std::vector<Box>& boxes,
-    float maxDist,
-    glm::vec3& hitPos,
-    int* outBoxIndex,
-    int* outFaceIndex)
+    //  origin      ̵̶ Ŷ  
+    // Ŷ ϳ ۾ ϳ,   ε ڸ ٷ Ἥ     
+    const int rayCount = (int)job.dirs.size();
+    const int packetCount = (rayCount + BoxBvh::MAX_PACKET - 1) / BoxBvh::MAX_PACKET;
+
+    std::vector<RayHit> hits(rayCount);
+    scanPool.ParallelFor(packetCount, [&](int p)
+        {
+            int first = p * BoxBvh::MAX_PACKET;
+            int n = std::min(BoxBvh::MAX_PACKET, rayCount - first);
+            TracePacket(job.origin, job.dirs.data() + first, n,
+                snap.boxes, snap.bvh, snap.grid, snap.soa, 1000.0f, hits.data() + first);
+        });
+
+    for (const RayHit& rh : hits)
+    {
+        if (rh.hit)
+        {
+            EmitHit(snap.boxes[rh.boxIndex], rh.boxIndex, rh.faceIndex, rh.hitPos, job.source, out);
+        }
+    }
+}
+
+void Lidar::ApplyScanHits(Map& map)
 {
-    bool hit = false;
-    float closestT = maxDist;
+    // ۾ڰ  Ʈ  ޾ƿ (ϰ ѱ  ״)
+    ScanHitBatch batch;
+    while (scanResults.TryPop(batch))
+    {
+        pendingHits.hits.insert(pendingHits.hits.end(), batch.hits.begin(), batch.hits.end());
+        raysInFlight -= batch.rayCount;
+    }
 
-    int bestBox = -1;
-    int bestFace = -1;
+    //  ť    ѱ ϰ
+    SubmitOverflowJobs();
 
-    for (int bi = 0; bi < boxes.size(); bi++)
+    ContinuePointExport();
+
+    //   д ̸ 길ŭ ̾  (  / ũ Ʒ Flush / Upload  ö)
+    bool loaded = ResumeSaveLoad(map);
+
+    //    ̸ 길ŭ ̾ (ҷ⸦      )
+    if (!loaded)
+        ContinueCompaction(map, COMPACT_BUDGET);
+
+    //     ޱ⸸  (ȭ鿡 ̴ ̹ )
+    if (pointLifetime > 0.0f)
     {
-        const Box& b = boxes[bi];
+        points.ReleaseExpired(pointClock - pointLifetime);
+    }
 
-        glm::vec3 half = b.size * 0.5f;
-        glm::vec3 minB = b.pos - half;
-        glm::vec3 maxB = b.pos + half;
+    if (pendingHits.Empty() && !loaded)
+    {
+        SaveProgress(map, false);
+        return;
+    }
+
+    hitBatch++;
 
-        float tmin = 0.0f;
-        float tmax = maxDist;
+    const std::vector<Box>& boxes = map.GetBoxes();
+    RevealMaskPages& revealPages = map.GetRevealPagesMutable();
+    int humanLayer = TextureManager::Get("human");
+
+    const auto applyStart = std::chrono::steady_clock::now();
+
+    for (const ScanHit& h : pendingHits.hits)
+    {
+        AddHitPoint(h.pos, (h.boxIndex >= 0 && h.faceIndex >= 0) ? h.boxIndex * 6 + h.faceIndex : -1);
+
+        // ȿ ڽ + face   revealMask 
+        if (h.boxIndex < 0 || h.boxIndex >= (int)boxes.size() || h.faceIndex < 0)
+            continue;
 
-        int hitFace = -1;
+        const Box& b = boxes[h.boxIndex];
 
-        // X  浹 Ǵ
-        if (fabs(dir.x) > 1e-6f)
+        if (h.source == ScanHitSource::Sweep)
         {
-            float tx1 = (minB.x - origin.x) / dir.x;
-            float tx2 = (maxB.x - origin.x) / dir.x;
-            if (tx1 > tx2) std::swap(tx1, tx2);
+            bool isHumanFace = humanLayer >= 0 && b.hasTex[h.faceIndex] && (b.texLayer[h.faceIndex] == humanLayer);
 
-            float old = tmin;
-            tmin = std::max(tmin, tx1);
-            tmax = std::min(tmax, tx2);
+            if (isHumanFace && !humanSoundPlayed)
+            {
+                //     ݾ ø
+                humanRevealScore += 0.002f;
 
-            if (tmin != old)
-                hitFace = (dir.x > 0) ? 2 : 3;  // -X = 2, +X = 3
+                const float PLAYSOUND = 0.3f;   //    ÷
 
-            if (tmin > tmax) continue;
+                if (humanRevealScore >= PLAYSOUND)
+                {
+                    AudioManager::Instance().Play("footstep_stranger");
+                    humanSoundPlayed = true;
+                }
+            }
         }
-        else
+
+        // revealMask  ؽó ִ 鿡 ̴ϱ  鿣   
+        //  ڽ  鵵  ( 踦 ġ ̰  )
+        if (!b.hasTex[h.faceIndex] || !(b.visibleFaces & (1 << h.faceIndex)))
+            continue;
+
+        const int R = (h.source == ScanHitSource::Sweep) ? SWEEP_STAMP_RADIUS : FAN_STAMP_RADIUS;
+
+        bool fresh = false;
+        int slot = revealPages.AcquireFaceSlot(h.boxIndex, h.faceIndex, fresh);
+        if (fresh)
         {
-            if (origin.x < minB.x || origin.x > maxB.x)
-                continue;
+            revealMasks.Clear(slot);
         }
 
-        // Y
-        if (fabs(dir.y) > 1e-6f)
-        {
-            float ty1 = (minB.y - origin.y) / dir.y;
-            float ty2 = (maxB.y - origin.y) / dir.y;
-            if (ty1 > ty2) std::swap(ty1, ty2);
+        revealMasks.Stamp(slot, h.u, h.v, R);
+        MarkMaskUnsaved(slot);
+    }
 
-            float old = tmin;
-            tmin = std::max(tmin, ty1);
-            tmax = std::min(tmax, ty2);
+    // ̹ ġ ĥ ũ  簢 ϳ ε
+    revealMasks.Flush(revealPages);
 
-            if (tmin != old)
-                hitFace = (dir.y > 0) ? 4 : 5;  // -Y = 4, +Y = 5
+    //    GPU 
+    points.Upload();
 
-            if (tmin > tmax) continue;
-        }
-        else
+    // Ʈ ϳ ݿ  (ĵ ٷ).      ð ̴ϱ  
+    if (!loaded && !pendingHits.Empty())
+    {
+        float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - applyStart).count();
+        applyCostPerHit += (ms / pendingHits.hits.size() - applyCostPerHit) * COST_SMOOTHING;
+    }
+
+    pendingHits.Clear();
+
+    SaveProgress(map, false);
+}
+
+bool Lidar::ExportPoints(const std::string& path, PointExportFormat format)
+{
+    if (exportActive)
+        return false;
+
+    if (!pointExporter.Begin(path, format))
+        return false;
+
+    exportActive = true;
+    exportBlockCursor = 0;
+    return true;
+}
+
+void Lidar::ContinuePointExport()
+{
+    if (!exportActive || !pointExporter.CanAccept())
+        return;
+
+    std::vector<ExportPoint> chunk;
+    chunk.reserve(PointExporter::CHUNK_POINTS);
+
+    //   ϱ  CHUNK_POINTS   ʰ  ϳ з  
+    while (exportBlockCursor < points.GetBlockCount()
+        && chunk.size() + POINT_BLOCK_SIZE <= PointExporter::CHUNK_POINTS)
+    {
+        points.ForEachPointInBlock(exportBlockCursor, [&chunk](const glm::vec3& p, float stamp, int surface)
+            {
+                ExportPoint e;
+                e.pos = p;
+                e.time = stamp;
+                e.boxIndex = (surface >= 0) ? surface / 6 : -1;
+                e.face = (surface >= 0) ? surface % 6 : -1;
+                chunk.push_back(e);
+            });
+        exportBlockCursor++;
+    }
+
+    pointExporter.Submit(std::move(chunk));
+
+    if (exportBlockCursor >= points.GetBlockCount())
+    {
+        //   ۾ 尡    ä 
+        pointExporter.End();
+        exportActive = false;
+    }
+}
+
+void Lidar::OpenSave(const std::string& path, const Map& map)
+{
+    CloseSave(map);
+
+    saveWriter.Start(path);
+
+    unsavedPoints.clear();
+    unsavedSlots.clear();
+    slotUnsaved.clear();
+    loadHasRecord = false;
+    loadPointCursor = 0;
+    compactActive = false;
+    compactedBytes = 0;
+    appendedBytes = 0;
+    lastSave = std::chrono::steady_clock::now();
+
+    //   ٷ ư. ڵ ApplyScanHits  Ӹ ݾ
+    if (saveReader.Open(path, (int)map.GetBoxes().size(), REVEAL_MASK_SIZE))
+    {
+        saveLoading = true;
+        return;
+    }
+
+    //  ų ٸ  ̸  ·  
+    saveLoading = false;
+    BeginCompaction(map);
+}
+
+void Lidar::CloseSave(const Map& map)
+{
+    if (saveLoading)
+    {
+        //   о  ״  ( ó ٽ )
+        saveReader.Close();
+        saveLoading = false;
+        loadHasRecord = false;
+        unsavedPoints.clear();
+        unsavedSlots.clear();
+        slotUnsaved.clear();
+    }
+    else
+    {
+        //  ̾  Ἥ ٲġ      
+        ContinueCompaction(map, std::chrono::steady_clock::duration::max());
+        SaveProgress(map, true);
+    }
+
+    saveWriter.Close();
+}
+
+bool Lidar::ResumeSaveLoad(Map& map)
+{
+    if (!saveLoading)
+        return false;
+
+    const auto start = std::chrono::steady_clock::now();
+    const int boxCount = (int)map.GetBoxes().size();
+    RevealMaskPages& revealPages = map.GetRevealPagesMutable();
+
+    while (true)
+    {
+        if (!loadHasRecord)
         {
-            if (origin.y < minB.y || origin.y > maxB.y)
-                continue;
+            if (!saveReader.Next(loadRecord))
+            {
+                //  :  ݰ,  ڵ   ϳ ļ ٽ  ( Ӻ )
+                saveReader.Close();
+                saveLoading = false;
+                BeginCompaction(map);
+                break;
+            }
+
+            loadHasRecord = true;
+            loadPointCursor = 0;
         }
 
-        // Z
-        if (fabs(dir.z) > 1e-6f)
+        const unsigned char* payload = loadRecord.payload;
+
+        switch (loadRecord.type)
         {
-            float tz1 = (minB.z - origin.z) / dir.z;
-            float tz2 = (maxB.z - origin.z) / dir.z;
-            if (tz1 > tz2) std::swap(tz1, tz2);
+        case SAVE_POINTS:
+        {
+            //  ڵ Ŭ  ־ LOAD_POINT_STEP    (߰    ӿ ̾)
+            const std::size_t stride = 3 * sizeof(float);
+            std::size_t n = loadRecord.size / stride;
+            std::size_t end = std::min(n, loadPointCursor + LOAD_POINT_STEP);
 
-            float old = tmin;
-            tmin = std::max(tmin, tz1);
-            tmax = std::min(tmax, tz2);
+            for (; loadPointCursor < end; loadPointCursor++)
+            {
+                float xyz[3];
+                std::memcpy(xyz, payload + loadPointCursor * stride, stride);
+                AddHitPoint(glm::vec3(xyz[0], xyz[1], xyz[2]), -1);   //  Ͽ   
+            }
 
-            if (tmin != old)
-                hitFace = (dir.z > 0) ? 0 : 1;  // -Z = 0, +Z = 1
+            if (loadPointCursor >= n)
+                loadHasRecord = false;
+            break;
+        }
 
-            if (tmin > tmax) continue;
+        case SAVE_MASK:
+        {
+            const std::uint32_t expected = 2 * sizeof(std::uint32_t) + REVEAL_MASK_SIZE * REVEAL_MASK_SIZE;
+            if (loadRecord.size == expected)
+            {
+                std::uint32_t boxIndex, face;
+                std::memcpy(&boxIndex, payload, sizeof(boxIndex));
+                std::memcpy(&face, payload + sizeof(boxIndex), sizeof(face));
+
+                //      int  ٲٱ  ȣ  ä  ˻ (2^31 ̻   ʰ)
+                if (boxIndex < (std::uint32_t)boxCount && face < 6)
+                {
+                    bool fresh = false;
+                    int slot = revealPages.AcquireFaceSlot((int)boxIndex, (int)face, fresh);
+                    revealMasks.Load(slot, payload + 2 * sizeof(std::uint32_t));
+                }
+            }
+            loadHasRecord = false;
+            break;
         }
-        else
+
+        case SAVE_STATE:
         {
-            if (origin.z < minB.z || origin.z > maxB.z)
-                continue;
+            if (loadRecord.size >= sizeof(float) + sizeof(std::uint32_t))
+            {
+                std::uint32_t played;
+                std::memcpy(&humanRevealScore, payload, sizeof(float));
+                std::memcpy(&played, payload + sizeof(float), sizeof(played));
+                humanSoundPlayed = (played != 0);
+            }
+            loadHasRecord = false;
+            break;
+        }
+
+        default:
+            // 𸣴 ڵ ǳʶ
+            loadHasRecord = false;
+            break;
         }
 
-        float tHit = tmin;
+        if (std::chrono::steady_clock::now() - start >= LOAD_BUDGET)
+            break;
+    }
+
+    return true;
+}
+
+void Lidar::MarkMaskUnsaved(int slot)
+{
+    if (!saveWriter.IsOpen() || saveLoading || slot < 0)
+        return;
 
-        if (tHit < 0.0f || tHit > maxDist)
+    if (slot >= (int)slotUnsaved.size())
+        slotUnsaved.resize(slot + 1, 0);
+
+    if (!slotUnsaved[slot])
+    {
+        slotUnsaved[slot] = 1;
+        unsavedSlots.push_back(slot);
+    }
+}
+
+void Lidar::SaveProgress(const Map& map, bool force)
+{
+    //  ߿ ׾Ƶα⸸  (   ٲϱ)
+    if (!saveWriter.IsOpen() || saveLoading || compactActive)
+        return;
+
+    const auto now = std::chrono::steady_clock::now();
+    if (!force && now - lastSave < SAVE_INTERVAL)
+        return;
+
+    lastSave = now;
+
+    std::vector<unsigned char> bytes;
+
+    AppendSavePoints(bytes, unsavedPoints.data(), unsavedPoints.size());
+    unsavedPoints.clear();
+
+    //  ٸ       (  Ͽ   ũ )
+    const RevealMaskPages& revealPages = map.GetRevealPages();
+    for (int slot : unsavedSlots)
+    {
+        slotUnsaved[slot] = 0;
+
+        int owner = revealPages.GetSlotOwner(slot);
+        const unsigned char* texels = revealMasks.GetTexels(slot);
+        if (owner < 0 || texels == nullptr)
+            continue;
+
+        AppendSaveMask(bytes, owner / 6, owner % 6, texels, REVEAL_MASK_SIZE);
+    }
+    unsavedSlots.clear();
+
+    if (humanRevealScore != savedRevealScore || humanSoundPlayed != savedSoundPlayed)
+    {
+        AppendSaveState(bytes, humanRevealScore, humanSoundPlayed);
+        savedRevealScore = humanRevealScore;
+        savedSoundPlayed = humanSoundPlayed;
+    }
+
+    appendedBytes += bytes.size();
+    saveWriter.Append(std::move(bytes));
+
+    //  ڵ尡  ִ ͺ ξ Ŀ ( ũ    )  
+    if (!force && appendedBytes > COMPACT_RATIO * std::max(compactedBytes, COMPACT_MIN_BYTES))
+        BeginCompaction(map);
+}
+
+void Lidar::BeginCompaction(const Map& map)
+{
+    std::vector<unsigned char> header;
+    AppendSaveHeader(header, (int)map.GetBoxes().size(), REVEAL_MASK_SIZE);
+    compactedBytes = header.size();
+    saveWriter.BeginRewrite(std::move(header));
+
+    //   ǥ .    / ũ  Ͽ  ϱ    
+    int blockCount = points.GetBlockCount();
+    compactBlockGenerations.resize(blockCount);
+    compactBlockCounts.resize(blockCount);
+    for (int bi = 0; bi < blockCount; bi++)
+    {
+        compactBlockGenerations[bi] = points.GetBlockGeneration(bi);
+        compactBlockCounts[bi] = points.GetBlockPointCount(bi);
+    }
+
+    unsavedPoints.clear();
+    for (int slot : unsavedSlots)
+        slotUnsaved[slot] = 0;
+    unsavedSlots.clear();
+
+    compactBlockCursor = 0;
+    compactSlotCursor = 0;
+    compactActive = true;
+}
+
+void Lidar::ContinueCompaction(const Map& map, std::chrono::steady_clock::duration budget)
+{
+    if (!compactActive)
+        return;
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<unsigned char> bytes;
+
+    // :    з,  ϳ ڵ ( ڷ   unsavedPoints   )
+    //     (  /   )  ǳʶ
+    std::vector<glm::vec3> blockPoints;
+    blockPoints.reserve(POINT_BLOCK_SIZE);
+    const int blockCount = (int)compactBlockCounts.size();
+    while (compactBlockCursor < blockCount && std::chrono::steady_clock::now() - start < budget)
+    {
+        int bi = compactBlockCursor++;
+        if (points.GetBlockGeneration(bi) != compactBlockGenerations[bi])
+            continue;
+
+        int remaining = compactBlockCounts[bi];
+        blockPoints.clear();
+        points.ForEachPointInBlock(bi, [&blockPoints, &remaining](const glm::vec3& p, float, int)
+            {
+                if (remaining-- > 0)
+                    blockPoints.push_back(p);
+            });
+        AppendSavePoints(bytes, blockPoints.data(), blockPoints.size());
+    }
+
+    // ũ:   ѱ    (  ٽ ĥ       )
+    const RevealMaskPages& revealPages = map.GetRevealPages();
+    while (compactBlockCursor >= blockCount
+        && compactSlotCursor < revealPages.GetUsedSlotCount()
+        && std::chrono::steady_clock::now() - start < budget)
+    {
+        int slot = compactSlotCursor++;
+        int owner = revealPages.GetSlotOwner(slot);
+        const unsigned char* texels = revealMasks.GetTexels(slot);
+        if (owner < 0 || texels == nullptr)
+            continue;
+
+        AppendSaveMask(bytes, owner / 6, owner % 6, texels, REVEAL_MASK_SIZE);
+    }
+
+    const bool done = compactBlockCursor >= blockCount && compactSlotCursor >= revealPages.GetUsedSlotCount();
+    if (done)
+    {
+        AppendSaveState(bytes, humanRevealScore, humanSoundPlayed);
+        savedRevealScore = humanRevealScore;
+        savedSoundPlayed = humanSoundPlayed;
+    }
+
+    compactedBytes += bytes.size();
+    saveWriter.RewritePart(std::move(bytes));
+
+    if (done)
+    {
+        saveWriter.EndRewrite();
+        compactActive = false;
+        compactBlockGenerations.clear();
+        compactBlockCounts.clear();
+        appendedBytes = 0;
+        lastSave = std::chrono::steady_clock::now();
+    }
+}
+
+
+bool Lidar::Raycast(
+    const glm::vec3& origin,
+    const glm::vec3& dir,
+    const std::vector<Box>& boxes,
+    float maxDist,
+    glm::vec3& hitPos,
+    int* outBoxIndex,
+    int* outFaceIndex)
+{
+    bool hit = false;
+    float closestT = maxDist;
+
+    int bestBox = -1;
+    int bestFace = -1;
+
+    for (int bi = 0; bi < boxes.size(); bi++)
+    {
+        const Box& b = boxes[bi];
+
+        glm::vec3 half = b.size * 0.5f;
+        glm::vec3 minB = b.pos - half;
+        glm::vec3 maxB = b.pos + half;
+
+        float tHit;
+        int hitFace;
+        if (!IntersectBoxSlab(minB, maxB, origin, dir, maxDist, tHit, hitFace))
             continue;
 
         if (tHit < closestT)
@@ -330,15 +928,144 @@ bool Lidar::Raycast(
     return true;
 }
 
+bool Lidar::TraceBoxes(
+    const glm::vec3& origin,
+    const glm::vec3& dir,
+    const std::vector<Box>& boxes,
+    const BoxBvh& bvh,
+    const GridIndex& grid,
+    const BoxSoA& soa,
+    float maxDist,
+    glm::vec3& hitPos,
+    int* outBoxIndex,
+    int* outFaceIndex)
+{
+    float t;
+    int bestBox, bestFace;
+    bool hit;
+
+    const RaycastMode mode = raycastMode.load();
+
+    if (mode == RaycastMode::Bvh && bvh.IsBuilt())
+    {
+        hit = bvh.Raycast(origin, dir, boxes, maxDist, t, bestBox, bestFace);
+    }
+    else if (mode == RaycastMode::GridDda && grid.IsBuilt())
+    {
+        hit = grid.Raycast(origin, dir, boxes, maxDist, t, bestBox, bestFace);
+    }
+    else if (mode == RaycastMode::Simd && soa.count == (int)boxes.size())
+    {
+        hit = RaycastBoxSoA(soa, origin, dir, maxDist, t, bestBox, bestFace);
+    }
+    else
+    {
+        return Raycast(origin, dir, boxes, maxDist, hitPos, outBoxIndex, outFaceIndex);
+    }
+
+    if (!hit) return false;
+
+    hitPos = origin + dir * t;
+
+    if (outBoxIndex)  *outBoxIndex = bestBox;
+    if (outFaceIndex) *outFaceIndex = bestFace;
+
+    return true;
+}
+
+bool Lidar::Raycast(
+    const glm::vec3& origin,
+    const glm::vec3& dir,
+    const Map& map,
+    float maxDist,
+    glm::vec3& hitPos,
+    int* outBoxIndex,
+    int* outFaceIndex)
+{
+    return TraceBoxes(origin, dir, map.GetBoxes(), map.GetBvh(), map.GetGrid(), map.GetBoxSoA(), maxDist, hitPos, outBoxIndex, outFaceIndex);
+}
+
+bool Lidar::RaycastAny(
+    const glm::vec3& origin,
+    const glm::vec3& dir,
+    const Map& map,
+    float maxDist)
+{
+    if (raycastMode.load() == RaycastMode::Bvh && map.GetBvh().IsBuilt())
+    {
+        return map.GetBvh().RaycastAny(origin, dir, map.GetBoxes(), maxDist);
+    }
+
+    glm::vec3 unused;
+    return Raycast(origin, dir, map, maxDist, unused);
+}
+
+void Lidar::TracePacket(
+    const glm::vec3& origin,
+    const glm::vec3* dirs,
+    int count,
+    const std::vector<Box>& boxes,
+    const BoxBvh& bvh,
+    const GridIndex& grid,
+    const BoxSoA& soa,
+    float maxDist,
+    RayHit* outHits)
+{
+    if (raycastMode.load() == RaycastMode::Bvh && bvh.IsBuilt())
+    {
+        bool  hit[BoxBvh::MAX_PACKET];
+        float t[BoxBvh::MAX_PACKET];
+        int   boxIndex[BoxBvh::MAX_PACKET];
+        int   faceIndex[BoxBvh::MAX_PACKET];
+
+        for (int first = 0; first < count; first += BoxBvh::MAX_PACKET)
+        {
+            int n = std::min(BoxBvh::MAX_PACKET, count - first);
+            bvh.RaycastPacket(origin, dirs + first, n, boxes, maxDist, hit, t, boxIndex, faceIndex);
+
+            for (int k = 0; k < n; k++)
+            {
+                RayHit& out = outHits[first + k];
+                out.hit = hit[k];
+                if (!hit[k])
+                    continue;
+
+                out.hitPos = origin + dirs[first + k] * t[k];
+                out.boxIndex = boxIndex[k];
+                out.faceIndex = faceIndex[k];
+            }
+        }
+        return;
+    }
+
+    // ٸ   ϳ
+    for (int i = 0; i < count; i++)
+    {
+        RayHit& out = outHits[i];
+        out.hit = TraceBoxes(origin, dirs[i], boxes, bvh, grid, soa, maxDist,
+            out.hitPos, &out.boxIndex, &out.faceIndex);
+    }
+}
+
+void Lidar::RaycastPacket(
+    const glm::vec3& origin,
+    const glm::vec3* dirs,
+    int count,
+    const Map& map,
+    float maxDist,
+    RayHit* outHits)
+{
+    TracePacket(origin, dirs, count, map.GetBoxes(), map.GetBvh(), map.GetGrid(), map.GetBoxSoA(), maxDist, outHits);
+}
 
 void Lidar::StartScan(const glm::vec3& origin,
     const glm::vec3& front,
     const glm::vec3& up,
-    const std::vector<Box>& boxes)
+    const Map& map)
 {
 
     scan.active = true;
-    scan.curRow = scan.vertical - 1;
+    scan.nextRay = 0;
 
     scan.origin = origin;
     scan.front = glm::normalize(front);
@@ -348,120 +1075,92 @@ void Lidar::StartScan(const glm::vec3& origin,
         right = glm::normalize(glm::cross(scan.front, glm::vec3(1, 0, 0))); // ׷ ü ؼ right 
 
     scan.up = glm::normalize(glm::cross(right, scan.front));    // ĵ  ¥ up 
-    scan.boxes = boxes;
+    scan.snapshot = AcquireSnapshot(map);
 
-    scan.rowTimer = 0.0f;
-    scan.rowInterval = 0.03f;
     debugRays.clear();
 }
 
-void Lidar::UpdateScan(float deltaTime)
+void Lidar::UpdateScan()
 {
     if (!scan.active) return;
 
-    scan.rowTimer += deltaTime;
-    if (scan.rowTimer < scan.rowInterval)
-    {
-        return;
-    }
-    scan.rowTimer = 0.0f;
+    const int totalRays = scan.horizontal * scan.vertical;
 
-    int row = scan.curRow;
-    if (row < 0)
+    //  ȿ    =  / (۾   + ݿ )
+    // ۾ڰ  з    ׸ŭ   и  Ӹ  ʰ 
+    float cost = std::max(traceCostPerRay.load() + applyCostPerHit, 1e-5f);
+    int budgetRays = std::max((int)(scanBudgetMs / cost), MIN_SCAN_RAYS);
+    int count = std::min(budgetRays - raysInFlight, totalRays - scan.nextRay);
+
+    if (count <= 0)
     {
-        scan.active = false;
         return;
     }
 
-    debugRays.clear();
-
     glm::vec3 forward = scan.front;
     glm::vec3 up = scan.up;
     glm::vec3 right = glm::normalize(glm::cross(forward, up));
 
-    float vAngle = ((float)row / (scan.vertical - 1) - 0.45f) * scan.vFov;   // row ε   -vFov/2 ~ +vFov/2 -> ̼, ¦  ø
+    ScanJob job;
+    job.snapshot = scan.snapshot;
+    job.origin = scan.origin;
+    job.source = ScanHitSource::Sweep;
+    job.dirs.reserve(count);
+
+    int lastRow = -1;
+    glm::quat qPitch;
 
-    for (int i = 0; i < scan.horizontal; i++)
+    for (int k = scan.nextRay; k < scan.nextRay + count; k++)
     {
+        int row = scan.vertical - 1 - k / scan.horizontal;
+        int i = k % scan.horizontal;
+
+        if (row != lastRow)
+        {
+            float vAngle = ((float)row / (scan.vertical - 1) - 0.45f) * scan.vFov;   // row ε   -vFov/2 ~ +vFov/2 -> ̼, ¦  ø
+            qPitch = glm::angleAxis(vAngle, right);   // right  ϴ ʹϾ
+            lastRow = row;
+        }
+
         float hAngle = ((float)i / (scan.horizontal - 1) - 0.5f) * scan.hFov;   // 
 
-        glm::quat qPitch = glm::angleAxis(vAngle, right);   // right  ϴ ʹϾ
         glm::quat qYaw = glm::angleAxis(hAngle, up);
         glm::quat q = qYaw * qPitch;    // ϳ ʹϾ ħ
 
         glm::vec3 dir = glm::normalize(q * forward);    // q * vector normalize ־  forward ʹϾ ٲٰ q x p x q* 
                                                         // ʹϾ ͸ ϸ   ִ operator* ε 
-        debugRays.push_back(dir);
-
-        glm::vec3 hit;
-        int boxIndex, faceIndex;
-        if (Raycast(scan.origin, dir, scan.boxes, 1000.0f, hit, &boxIndex, &faceIndex))
-        {
-            AddHitPoint(hit);
-
-            // ⿡ revealMask ĥϱ
-            Box& b = scan.boxes[boxIndex];
-
-            GLuint humanTex = TextureManager::Get("human");
-            bool isHumanFace = (b.texID[faceIndex] == humanTex);
-
-            if (isHumanFace && !humanSoundPlayed)
-            {
-                //     ݾ ø
-                humanRevealScore += 0.002f;
-
-                const float PLAYSOUND = 0.3f;   //    ÷
-
-                if (humanRevealScore >= PLAYSOUND)
-                {
-                    AudioManager::Instance().Play("footstep_stranger");
-                    humanSoundPlayed = true;
-                }
-            }
-
-            float u, v;
-            ComputeFaceUV(b, faceIndex, b.texRot[faceIndex], hit, u, v);
-
-            int X = int(u * 255);
-            int Y = int(v * 255);
-
-            glBindTexture(GL_TEXTURE_2D, b.revealMask[faceIndex]);
-
-            const int R = 6;
-            unsigned char value = 255;
+        job.dirs.push_back(dir);
+    }
 
-            for (int j = -R; j <= R; j++)
-                for (int i = -R; i <= R; i++)
-                {
-                    if (i * i + j * j > R * R) continue;
+    //  ׸    з (       ٸŭ ׸)
+    std::size_t shown = std::min(job.dirs.size(), (std::size_t)scan.horizontal);
+    debugRays.assign(job.dirs.end() - shown, job.dirs.end());
 
-                    int tx = X + i;
-                    int ty = Y + j;
+    // ѱ ٷ ư ( / Ʈ  ۾ 忡)
+    SubmitScanJob(std::move(job));
 
-                    if (tx < 0 || tx > 255 || ty < 0 || ty > 255) continue;
+    scan.nextRay += count;
 
-                    glTexSubImage2D(GL_TEXTURE_2D, 0,
-                        tx, ty,
-                        1, 1,
-                        GL_RED, GL_UNSIGNED_BYTE,
-                        &value);
-                }
-        }
+    if (scan.nextRay >= totalRays)
+    {
+        scan.active = false;
+        scan.snapshot.reset();
     }
-
-    scan.curRow--;   //  ٷ Ѿ
 }
 
 
 void Lidar::Draw(GLuint shaderProgram,
+    const Map& map,
     GLint uModelLoc,
-    GLint uViewLoc,
-    GLint uProjLoc,
+    GLint uNormalMatLoc,
+    GLint uViewProjLoc,
     GLint uColorLoc,
+    GLint uTimeLoc,
+    GLint uPointLifetimeLoc,
     const glm::mat4& view,
     const glm::mat4& proj) const
 {
-    if (points.empty())
+    if (points.Size() == 0)
     {
         return;
     }
@@ -469,20 +1168,51 @@ void Lidar::Draw(GLuint shaderProgram,
     glUseProgram(shaderProgram);
     glBindVertexArray(VAO);
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(glm::vec3) * points.size(), points.data());
+    // ε ApplyScanHits    ص
+    // ī޶ ġ view  ̵ 
+    glm::vec3 cameraPos = glm::vec3(glm::inverse(view)[3]);
 
-    glm::mat4 model = glm::mat4(1.0f);
-    glUniformMatrix4fv(uModelLoc, 1, GL_FALSE, glm::value_ptr(model));
-    glUniformMatrix4fv(uViewLoc, 1, GL_FALSE, glm::value_ptr(view));
-    glUniformMatrix4fv(uProjLoc, 1, GL_FALSE, glm::value_ptr(proj));
+    // uModel  ûũ PointCloud::Draw   (ȭ Ǯ)
+    // ûũ model  ̵ +  ϻ̶   (0, 1, 0)   ٲ ->      
+    glm::mat4 viewProj = proj * view;
+    glm::mat3 normalMat(1.0f);
+    glUniformMatrix3fv(uNormalMatLoc, 1, GL_FALSE, glm::value_ptr(normalMat));
+    glUniformMatrix4fv(uViewProjLoc, 1, GL_FALSE, glm::value_ptr(viewProj));
 
     // ̴   ( ʷϻ 迭)
     glm::vec3 color(0.0f, 1.0f, 0.4f);
     glUniform3fv(uColorLoc, 1, glm::value_ptr(color));
 
+    //   = uTime - aCaptureTime
+    glUniform1f(uTimeLoc, pointClock);
+    glUniform1f(uPointLifetimeLoc, pointLifetime);
+
+    // ûũ ( CHUNK_CELLS x CHUNK_CELLS) ȿ ī޶    ִ  ϳ  ׸
+    std::vector<unsigned char> chunkVisible;
+    const CellVisibility& visibility = map.GetVisibility();
+    int cameraCell = visibility.CellOf(cameraPos);
+    if (cameraCell >= 0)
+    {
+        int w = visibility.GetWidth();
+        int h = visibility.GetHeight();
+        int nx = (w + CHUNK_CELLS - 1) / CHUNK_CELLS;
+        int nz = (h + CHUNK_CELLS - 1) / CHUNK_CELLS;
+        chunkVisible.assign(nx * nz, 0);
+
+        for (int z = 0; z < h; z++)
+        {
+            for (int x = 0; x < w; x++)
+            {
+                if (visibility.IsVisible(cameraCell, z * w + x))
+                    chunkVisible[(z / CHUNK_CELLS) * nx + x / CHUNK_CELLS] = 1;
+            }
+        }
+    }
+
     glPointSize(4.0f);
-    glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(points.size()));
+    points.Draw(viewProj, cameraPos, uModelLoc, chunkVisible);
+
+    glUniform1f(uPointLifetimeLoc, 0.0f);
 
     glBindVertexArray(0);
 }
@@ -1,15 +1,87 @@
 #pragma once
 
 #include <vector>
+#include <deque>
+#include <string>
+#include <chrono>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <cstddef>
 
 #include <gl/glew.h>
 #include <gl/glm/glm.hpp>
 #include "Map.h"  
+#include "WorkerPool.h"
+#include "RevealMask.h"
+#include "PointCloud.h"
+#include "VoxelHash.h"
+#include "ScanSave.h"
+#include "SpscQueue.h"
+#include "PointExport.h"
+
+// ĳƮ   
+enum class RaycastMode
+{
+    BruteForce, // ڽ  ˻
+    Bvh,        // BoxBvh
+    GridDda,    // GridIndex  3D-DDA   (  )
+    Simd        // BoxSoA  SSE / AVX    4 / 8 ˻
+};
+
+//  ϳ 
+struct RayHit {
+    bool hit = false;
+    glm::vec3 hitPos = glm::vec3(0.0f);
+    int boxIndex = -1;
+    int faceIndex = -1;
+};
+
+// Ʈ  Դ (  ũ / human  ΰ ٸ)
+enum class ScanHitSource {
+    Fan,    // Ŭ ScanFan
+    Sweep   // Ŭ UpdateScan
+};
+
+//  ܰ迡  Ʈ ϳ. GL /   ǵ帮 ݿ ܰ迡    
+struct ScanHit {
+    glm::vec3 pos;
+    int boxIndex;
+    int faceIndex;      // ڽ ȿ   -1
+    float u, v;         // revealMask ǥ (texRot ݿ)
+    ScanHitSource source;
+};
+
+struct ScanHitBatch {
+    std::vector<ScanHit> hits;
+    int rayCount = 0;   // ۾ڰ       (Ʈ   ٷ )
+
+    void Clear() { hits.clear(); }
+    bool Empty() const { return hits.empty(); }
+};
+
+// ĵ ۾ڰ ̸   纻.  ڷδ  ٲ (۾ / GLUT 尡  б⸸ )
+struct ScanSnapshot {
+    std::vector<Box> boxes;
+    BoxBvh bvh;
+    GridIndex grid;
+    BoxSoA soa;
+};
+
+// ĵ ۾ڿ ѱ ϰ ϳ: origin  dirs  ̸ snapshot   
+// ()   ׸⿡ ϱ GLUT 忡 ̸ ؼ 
+struct ScanJob {
+    std::shared_ptr<const ScanSnapshot> snapshot;
+    glm::vec3 origin = glm::vec3(0.0f);
+    std::vector<glm::vec3> dirs;
+    ScanHitSource source = ScanHitSource::Fan;
+};
 
 struct ScanState {
     bool active = false;   // ĵ 
-    int curRow = 0;        //  ó  vertical index
+    int nextRay = 0;       //  ѱ  ( vertical - 1  Ʒ,  ȿ ʺ)
     int horizontal = 80;   // ¿  
     int vertical = 80;     // Ʒ  
     float hFov = glm::radians(80.0f);
@@ -17,10 +89,7 @@ struct ScanState {
     glm::vec3 origin;
     glm::vec3 front;
     glm::vec3 up;
-    std::vector<Box> boxes;
-
-    float rowTimer;     //  ٷ Ѿ  ð
-    float rowInterval;  //  ϳ ĵ ͹
+    std::shared_ptr<const ScanSnapshot> snapshot;  // StartScan   (ĵϴ    ״)
 };
 
 class Lidar
@@ -28,22 +97,26 @@ class Lidar
 public:
     Lidar();
     ~Lidar();
-    // VAO / VBO ʱȭ
-    void Init();
+    // VAO / VBO ʱȭ + ĵ ۾  
+    // Ʈ ûũ   ڿ  (InitFromArray  θ )
+    void Init(const Map& map);
 
     //  Ʈ  
-    void Clear() { points.clear(); }
+    void Clear() { points.Clear(); voxels.Clear(); }
 
-    const std::vector<glm::vec3>& GetPoints() const { return points; }
+    // ûũ Ʈ Ŭ
+    const PointCloud& GetPoints() const { return points; }
     
-    size_t GetPointCount() const { return points.size(); }
+    size_t GetPointCount() const { return points.Size(); }
 
     // origin  dir   1 ,
-    // Map  ڽ    
+    // Map  ڽ    Ʈ Ͽ  (ݿ ApplyScanHits )
+    // ̰ θ 忡 ٷ 
     void ScanSingleRay(const glm::vec3& origin,
         const glm::vec3& dir,
         const Map& map);
 
+    //  ֺ   ̵ ĵ ۾ڿ ѱ (  ApplyScanHits  )
     void ScanFan(const glm::vec3& origin,
         const glm::vec3& front,
         const Map& map);
@@ -58,19 +131,158 @@ public:
         int* outFaceIndex = nullptr
     );
 
+    // map  BVH / ڷ   ڽ ã (   Ʈ  )
+    bool Raycast(
+        const glm::vec3& origin,
+        const glm::vec3& dir,
+        const Map& map,
+        float maxDist,
+        glm::vec3& hitPos,
+        int* outBoxIndex = nullptr,
+        int* outFaceIndex = nullptr
+    );
+
+    //  origin    count    (BVH 忡 16 Ŷ)
+    //  ̸ Raycast  Ͱ Ʈ  
+    void RaycastPacket(
+        const glm::vec3& origin,
+        const glm::vec3* dirs,
+        int count,
+        const Map& map,
+        float maxDist,
+        RayHit* outHits
+    );
+
+    // maxDist ȿ  ڽ ִ Ȯ
+    bool RaycastAny(
+        const glm::vec3& origin,
+        const glm::vec3& dir,
+        const Map& map,
+        float maxDist
+    );
+
+    void SetRaycastMode(RaycastMode mode)
+    {
+        raycastMode.store(mode);
+    }
+
+    RaycastMode GetRaycastMode() const
+    {
+        return raycastMode.load();
+    }
+
+    // ĵ ۾ڰ      (۾  , 1̸ ۾ ȥ)
+    //    ļ    ׻ 
+    // ۾ڰ Ǯ    ־ ۾ڸ  ٰ ٽ  (ť  ϰ ״)
+    void SetScanThreads(int count);
+
+    int GetScanThreads() const
+    {
+        return scanPool.GetThreadCount();
+    }
+
+    //  ߺ : Ѹ ̹  ִ   Ʈ   װ Ʈ  ø
+    // voxelSize  ٲٸ   ʱȭ (̹   ״)
+    void SetPointDedup(bool enable, float voxelSize)
+    {
+        dedupEnabled = enable;
+        voxels.SetVoxelSize(voxelSize);
+    }
+
+    bool IsPointDedupEnabled() const
+    {
+        return dedupEnabled;
+    }
+
+    //   ð (). Ӹ ApplyScanHits  ־
+    void SetClock(float seconds)
+    {
+        pointClock = seconds;
+    }
+
+    //   ().  ̴   ° . 0 ̸  
+    void SetPointLifetime(float seconds)
+    {
+        pointLifetime = seconds;
+    }
+
+    float GetPointLifetime() const
+    {
+        return pointLifetime;
+    }
+
+    //  Ʈ  /   ġ
+    const VoxelHash& GetVoxels() const
+    {
+        return voxels;
+    }
+
     void StartScan(const glm::vec3& origin,
         const glm::vec3& front,
         const glm::vec3& up,
-        const std::vector<Box>& boxes);
+        const Map& map);
+
+    // ̹  길ŭ ̸ ĵ ۾ڿ ѱ⸸  ( ۾ 忡)
+    //  ϳ (۾  + ApplyScanHits ݿ) 缭  /  ŭ .  ߰ ⵵ ϰ     ⵵ 
+    void UpdateScan();
+
+    // Ӵ ĵ  ð (ms). ǥ  ð  ʿ ŭ   
+    void SetScanBudget(float ms)
+    {
+        scanBudgetMs = ms;
+    }
+
+    float GetScanBudget() const
+    {
+        return scanBudgetMs;
+    }
+
+    // ۾ڰ  Ʈ  ޾Ƽ   ݿ: Ʈ ߰ / revealMask ĥϱ / human Ʈ
+    // GL  ǵ帮ϱ GLUT 忡 Ӵ   ȣ
+    // revealMask  ó ĥϴ 鿡 ⼭  (׷ Map  const  ƴ)
+    void ApplyScanHits(Map& map);
+
+    // ĵ  Ȳ    (Init ).  Ȯϰ ٷ ƿ
+    // ´ ̸ ApplyScanHits  Ӹ  ms   о ̰,
+    //   (Ȥ  ų ٸ ̸)  ·     ʹ   ͸ 
+    //    ()  Ӹ  ms   
+    void OpenSave(const std::string& path, const Map& map);
 
-    void UpdateScan(float deltaTime);
+    //   ۾     ( )
+    void CloseSave(const Map& map);
+
+    bool IsLoadingSave() const
+    {
+        return saveLoading;
+    }
+
+    //  Ŭ带 PLY / LAS    (̹ ϴ ̸ false)
+    // ApplyScanHits  Ӹ     ѱ,   ۾ 忡 
+    //  ߿ зų       ȾĿ  ⵵ ϰ ⵵ 
+    bool ExportPoints(const std::string& path, PointExportFormat format);
+
+    bool IsExportingPoints() const
+    {
+        return exportActive;
+    }
+
+    //  ݿ   Ʈ
+    const ScanHitBatch& GetPendingHits() const
+    {
+        return pendingHits;
+    }
 
     //  Ʈ GL_POINTS  
+    // uTimeLoc / uPointLifetimeLoc    (׸   0   ٸ ü  )
+    // map   ü ī޶   ̴ ûũ ǳʶ
     void Draw(GLuint shaderProgram,
+        const Map& map,
         GLint uModelLoc,
-        GLint uViewLoc,
-        GLint uProjLoc,
+        GLint uNormalMatLoc,
+        GLint uViewProjLoc,
         GLint uColorLoc,
+        GLint uTimeLoc,
+        GLint uPointLifetimeLoc,
         const glm::mat4& view,
         const glm::mat4& proj) const;
 
@@ -91,16 +303,137 @@ public:
 
 private:
     GLuint VAO;
-    GLuint VBO;
     ScanState scan;
 
-    std::vector<glm::vec3> points;
-    std::size_t maxPoints;
+    PointCloud points;
+
+    VoxelHash voxels;
+    bool dedupEnabled = false;
+    unsigned int hitBatch = 0;      // ApplyScanHits ȣ  ( lastSeen )
+
+    float pointClock = 0.0f;
+    float pointLifetime = 0.0f;
 
     std::vector<glm::vec3> debugRays;
 
+    ScanHitBatch pendingHits;
+
+    RevealMaskCache revealMasks;
+
     float humanRevealScore = 0.0f;   // human 󸶳 ĵƴ  
     bool  humanSoundPlayed = false;
 
-    void AddHitPoint(const glm::vec3& p);
+    // ĵ ۾ڵ ϱ atomic (   Ƽ ĵ ߿ ٲ )
+    std::atomic<RaycastMode> raycastMode{ RaycastMode::Bvh };
+
+    //  
+    ScanSaveWriter saveWriter;
+    ScanSaveReader saveReader;
+    bool saveLoading = false;
+    bool loadHasRecord = false;             // loadRecord     о
+    ScanSaveReader::Record loadRecord;
+    std::size_t loadPointCursor = 0;        // SAVE_POINTS ڵ忡   
+    std::vector<glm::vec3> unsavedPoints;   //   ڷ   
+    std::vector<int> unsavedSlots;          //   ڷ ĥ ũ 
+    std::vector<char> slotUnsaved;          //  -> unsavedSlots   ִ
+    float savedRevealScore = 0.0f;
+    bool savedSoundPlayed = false;
+    std::chrono::steady_clock::time_point lastSave;
+
+    //   ٽ  ().    ǥ ΰ  з Ӹ ݾ ѱ
+    //      / ũ unsaved ʿ ׿ٰ    Ͽ 
+    bool compactActive = false;
+    int compactBlockCursor = 0;
+    int compactSlotCursor = 0;
+    std::vector<std::uint32_t> compactBlockGenerations;
+    std::vector<int> compactBlockCounts;
+    std::size_t compactedBytes = 0;     //     ũ (=  ִ )
+    std::size_t appendedBytes = 0;      //  ڷ  ũ
+
+    WorkerPool scanPool;         // ۾ 常 
+
+    // ĵ ۾: GLUT  -> ۾ڴ scanJobs, ۾ -> GLUT  scanResults (    SPSC)
+    // ۾ڰ      뵵θ mutex / condition_variable  
+    std::thread scanThread;
+    SpscQueue<ScanJob> scanJobs{ 256 };
+    SpscQueue<ScanHitBatch> scanResults{ 256 };
+    std::deque<ScanJob> overflowJobs;   // scanJobs   á  GLUT 尡   ִ ϰ ( )
+    std::mutex scanWakeMutex;
+    std::condition_variable scanWakeCv;
+    std::atomic<bool> scanStop{ false };
+    ScanHitBatch strandedBatch;         //    ť    ѱ  (join ڿ )
+
+    // ĵ ٷ (UpdateScan)
+    float scanBudgetMs = 4.0f;
+    std::atomic<float> traceCostPerRay{ 0.002f };   // ms, ۾ڰ ϰ   ̵ 
+    float applyCostPerHit = 0.001f;                 // ms, ApplyScanHits    ̵ 
+    int raysInFlight = 0;                           // ۾ڿ Ѱµ    ƿ 
+
+    // Ʈ 
+    PointExporter pointExporter;
+    bool exportActive = false;
+    int exportBlockCursor = 0;      //   PointCloud 
+
+    //   ٲ ScanFan     
+    std::shared_ptr<const ScanSnapshot> liveSnapshot;
+    unsigned int liveSnapshotVersion = 0;
+
+    // surface = ڽ * 6 +  (𸣸 -1)
+    void AddHitPoint(const glm::vec3& p, int surface);
+
+    //   ̾ б (ð  ȿ).  о true
+    bool ResumeSaveLoad(Map& map);
+
+    //   ϳ  ѱ (۾ 尡 з  ̹  ǳʶ)
+    void ContinuePointExport();
+
+    //   ڷ ٲ ͸   ѱ (force  ƴϸ  ݸ)
+    //   ʹ   
+    void SaveProgress(const Map& map, bool force);
+
+    //   ü  Ϸ   / budget ȿ ̾  ( ٲġ)
+    void BeginCompaction(const Map& map);
+    void ContinueCompaction(const Map& map, std::chrono::steady_clock::duration budget);
+
+    void MarkMaskUnsaved(int slot);
+
+    void EmitHit(const Box& b, int boxIndex, int faceIndex, const glm::vec3& hit, ScanHitSource source, ScanHitBatch& out) const;
+
+    std::shared_ptr<const ScanSnapshot> AcquireSnapshot(const Map& map);
+
+    // GLUT 忡 ϰ ѱ / ۾ 
+    void SubmitScanJob(ScanJob&& job);
+    void SubmitOverflowJobs();
+    void WakeScanWorker();
+    void StartScanWorker();
+    void StopScanWorker();
+
+    // ۾ 
+    void ScanWorkerLoop();
+    void RunScanJob(const ScanJob& job, ScanHitBatch& out);
+
+    bool TraceBoxes(
+        const glm::vec3& origin,
+        const glm::vec3& dir,
+        const std::vector<Box>& boxes,
+        const BoxBvh& bvh,
+        const GridIndex& grid,
+        const BoxSoA& soa,
+        float maxDist,
+        glm::vec3& hitPos,
+        int* outBoxIndex,
+        int* outFaceIndex
+    );
+
+    void TracePacket(
+        const glm::vec3& origin,
+        const glm::vec3* dirs,
+        int count,
+        const std::vector<Box>& boxes,
+        const BoxBvh& bvh,
+        const GridIndex& grid,
+        const BoxSoA& soa,
+        float maxDist,
+        RayHit* outHits
+    );
 };
@@ -1,24 +1,82 @@
 #include "Map.h"
 
 #include <stdio.h>
+#include <algorithm>
+#include <utility>
 #include <gl/glew.h>
 #include <gl/freeglut.h>
 #include <gl/glm/gtc/matrix_transform.hpp>
 #include <gl/glm/gtc/type_ptr.hpp>
 #include "TextureManager.h"
 
-static void CreateRevealMask(GLuint& tex)
+namespace
 {
-    glGenTextures(1, &tex);
-    glBindTexture(GL_TEXTURE_2D, tex);
+    // main  InitCubeMesh    ť (pos, normal, uv /   -Z +Z -X +X -Y +Y)
+    const float CUBE_VERTICES[24][8] =
+    {
+        { -0.5f,-0.5f,-0.5f,   0,0,-1,   0,0 },
+        {  0.5f,-0.5f,-0.5f,   0,0,-1,   1,0 },
+        {  0.5f, 0.5f,-0.5f,   0,0,-1,   1,1 },
+        { -0.5f, 0.5f,-0.5f,   0,0,-1,   0,1 },
+
+        { -0.5f,-0.5f, 0.5f,   0,0,1,    0,0 },
+        {  0.5f,-0.5f, 0.5f,   0,0,1,    1,0 },
+        {  0.5f, 0.5f, 0.5f,   0,0,1,    1,1 },
+        { -0.5f, 0.5f, 0.5f,   0,0,1,    0,1 },
+
+        { -0.5f,-0.5f,-0.5f,  -1,0,0,    0,0 },
+        { -0.5f, 0.5f,-0.5f,  -1,0,0,    0,1 },
+        { -0.5f, 0.5f, 0.5f,  -1,0,0,    1,1 },
+        { -0.5f,-0.5f, 0.5f,  -1,0,0,    1,0 },
+
+        {  0.5f,-0.5f,-0.5f,   1,0,0,    0,0 },
+        {  0.5f, 0.5f,-0.5f,   1,0,0,    0,1 },
+        {  0.5f, 0.5f, 0.5f,   1,0,0,    1,1 },
+        {  0.5f,-0.5f, 0.5f,   1,0,0,    1,0 },
+
+        { -0.5f,-0.5f,-0.5f,   0,-1,0,   0,0 },
+        {  0.5f,-0.5f,-0.5f,   0,-1,0,   1,0 },
+        {  0.5f,-0.5f, 0.5f,   0,-1,0,   1,1 },
+        { -0.5f,-0.5f, 0.5f,   0,-1,0,   0,1 },
+
+        { -0.5f, 0.5f,-0.5f,   0,1,0,    0,0 },
+        {  0.5f, 0.5f,-0.5f,   0,1,0,    1,0 },
+        {  0.5f, 0.5f, 0.5f,   0,1,0,    1,1 },
+        { -0.5f, 0.5f, 0.5f,   0,1,0,    0,1 },
+    };
+
+    const unsigned int CUBE_INDICES[36] =
+    {
+        1,0,3,  3,2,1,
+        4,5,6,  6,7,4,
+        11,10,9, 9,8,11,
+        12,13,14, 14,15,12,
+        16,17,18, 18,19,16,
+        20,23,22, 22,21,20
+    };
+
+    const int FLOATS_PER_VERTEX = 8;
+
+    // ڽ    ǥ ﰢ 2 (6 )  Ǯ 
+    void AppendFace(std::vector<float>& vertices, const Box& b, int face)
+    {
+        for (int k = 0; k < 6; k++)
+        {
+            const float* v = CUBE_VERTICES[CUBE_INDICES[face * 6 + k]];
 
-    const int SIZE = 256;
-    std::vector<unsigned char> blank(SIZE * SIZE, 0);
+            glm::vec3 p = b.pos + glm::vec3(v[0], v[1], v[2]) * b.size;
+            glm::vec2 uv(v[6], v[7]);
 
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, SIZE, SIZE, 0, GL_RED, GL_UNSIGNED_BYTE, blank.data());
+            // fragment.glsl  uTexRot / uFlipX ó  
+            if (b.texRot[face] == 1)
+                uv = glm::vec2(1.0f) - uv;
+            if (b.texFlipX[face])
+                uv.x = 1.0f - uv.x;
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            const float out[FLOATS_PER_VERTEX] = { p.x, p.y, p.z, v[3], v[4], v[5], uv.x, uv.y };
+            vertices.insert(vertices.end(), out, out + FLOATS_PER_VERTEX);
+        }
+    }
 }
 
 void Map::Draw(
@@ -26,63 +84,323 @@ void Map::Draw(
     GLuint shaderProgram,
     GLuint vaoCube,
     GLint uModelLoc,
-    GLint uViewLoc,
-    GLint uProjLoc,
+    GLint uNormalMatLoc,
+    GLint uViewProjLoc,
     GLint uColorLoc,
     GLint uTexRotLoc,
     GLint uHasTexLoc,
     GLint uTextureLoc,
     GLint uRevealMaskLoc,
+    GLint uRevealLayerLoc,
     GLint uFlipXLoc,
+    GLint uTexLayerLoc,
+    GLint uInstancedLoc,
+    GLint uMaterialLoc,
     const glm::mat4& view,
     const glm::mat4& proj
-) const
+)
 {
     glUseProgram(shaderProgram);
-    glBindVertexArray(vaoCube);
 
-    glUniformMatrix4fv(uViewLoc, 1, GL_FALSE, glm::value_ptr(view));
-    glUniformMatrix4fv(uProjLoc, 1, GL_FALSE, glm::value_ptr(proj));
+    glm::mat4 viewProj = proj * view;
+    glUniformMatrix4fv(uViewProjLoc, 1, GL_FALSE, glm::value_ptr(viewProj));
+
+    //  ؽó  迭 ϳ ӿ   εϰ 鸶ٴ ̾ ȣ ѱ
+    // (RevealMaskCache::Flush  ׶  ִ ֿ revealMask  εϰ    ٽ )
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, TextureManager::GetArray());
+    glUniform1i(uTextureLoc, 0);
+
+    // revealMask  ؽó 迭̶  ٲ  ε
+    glActiveTexture(GL_TEXTURE1);
+    glUniform1i(uRevealMaskLoc, 1);
+    GLuint boundRevealPage = 0;
+
+    //  ޽: ̹  ǥ model   , uv   ־ ȸ /  
+    glm::mat4 identity(1.0f);
+    glm::mat3 normalMat(1.0f);
+    glUniformMatrix4fv(uModelLoc, 1, GL_FALSE, glm::value_ptr(identity));
+    glUniformMatrix3fv(uNormalMatLoc, 1, GL_FALSE, glm::value_ptr(normalMat));
+    glUniform1i(uTexRotLoc, 0);
+    glUniform1i(uFlipXLoc, 0);
+
+    glBindVertexArray(staticVao);
+
+    // ī޶     ִ  ( ̸ -1 ̶ )
+    int cameraCell = visibility.CellOf(glm::vec3(glm::inverse(view)[3]));
+
+    glUniform1i(uHasTexLoc, 0);
+    for (const StaticColorBatch& batch : staticBatches)
+    {
+        drawFirsts.clear();
+        drawCounts.clear();
+
+        // ģ   ϳ ̴ 簢, ̾ ͳ ٿ  
+        for (const StaticQuad& q : batch.quads)
+        {
+            if (q.cellX0 >= 0 && !visibility.IsAnyVisible(cameraCell, q.cellX0, q.cellZ0, q.cellX1, q.cellZ1))
+                continue;
+
+            if (!drawFirsts.empty() && drawFirsts.back() + drawCounts.back() == q.first)
+                drawCounts.back() += 6;
+            else
+            {
+                drawFirsts.push_back(q.first);
+                drawCounts.push_back(6);
+            }
+        }
 
-    for (const Box& b : boxes)
+        if (drawFirsts.empty())
+            continue;
+
+        glUniform3fv(uColorLoc, 1, glm::value_ptr(batch.color));
+        glMultiDrawArrays(GL_TRIANGLES, drawFirsts.data(), drawCounts.data(), (GLsizei)drawFirsts.size());
+    }
+
+    // ؽó ִ     ǰ revealMask ̾ 鸶 ޶ (ó ĥ  ) 鸶 ׸
+    // ؽó ε  uniform   ( ؽó ̾ / revealMask ̾)  ٲ
+    glUniform1i(uHasTexLoc, 1);
+    for (const StaticTexturedFace& f : staticTextured)
     {
+        if (f.cell >= 0 && !visibility.IsVisible(cameraCell, f.cell))
+            continue;
 
-        glm::mat4 model = glm::translate(glm::mat4(1.0f), b.pos);
-        model = glm::scale(model, b.size);
+        const Box& b = boxes[f.boxIndex];
 
-        glUniformMatrix4fv(uModelLoc, 1, GL_FALSE, glm::value_ptr(model));
-        
         glUniform3fv(uColorLoc, 1, glm::value_ptr(b.color));
+        glUniform1i(uTexLayerLoc, b.texLayer[f.face]);
+
+        int slot = revealPages.GetFaceSlot(f.boxIndex, f.face);
+        GLuint page = revealPages.GetSlotTexture(slot);
+        if (page != boundRevealPage)
+        {
+            glBindTexture(GL_TEXTURE_2D_ARRAY, page);
+            boundRevealPage = page;
+        }
+        glUniform1i(uRevealLayerLoc, RevealMaskPages::LayerOf(slot));
+
+        glDrawArrays(GL_TRIANGLES, f.first, 6);
+    }
+
+    glBindVertexArray(0);
+
+    // ̴ ڽ ( / Űе / ɾ ڽ)  νϽ ڵ (ġ / ũ / 麰   νϽ Ӽ)
+    if (!dynamicInstances.IsReady())
+        dynamicInstances.Init(vaoCube);
+
+    int dynamicStart = std::max(doorIndex, 0);
+    dynamicInstances.Update(boxes, dynamicStart, (int)boxes.size() - dynamicStart, revealPages);
+    dynamicInstances.Draw(uInstancedLoc, uMaterialLoc);
+}
+
+void Map::BuildStaticMesh()
+{
+    staticBatches.clear();
+    staticTextured.clear();
+
+    int staticEnd = (doorIndex >= 0) ? doorIndex : (int)boxes.size();
+
+    auto batchOf = [&](const glm::vec3& color)
+    {
+        int batch = 0;
+        while (batch < (int)staticBatches.size() && staticBatches[batch].color != color)
+            batch++;
+
+        if (batch == (int)staticBatches.size())
+            staticBatches.push_back({ color, {} });
+        return batch;
+    };
+
+    // ģ 簢 ϳ =    ¥ ڽ face  (AppendFace  ״ )
+    struct PendingQuad
+    {
+        Box shape;
+        int face;
+        int batch;
+        int cellX0, cellZ0, cellX1, cellZ1;
+    };
+    std::vector<PendingQuad> pending;
+
+    //    °   ڽ ؽó  :  /  2D ũ 
+    //    η ִ ø  η ÷ 簢 ϳ ħ
+    // ؽó   uv / revealMask   Ἥ (fragment.glsl) ĵ ׸ 
+    std::vector<unsigned char> mergedFaces(staticEnd, 0);
+
+    if (grid.IsBuilt())
+    {
+        glm::vec3 gridMin = grid.GetOrigin();
+        glm::vec3 cellSize = grid.GetCellSize();
 
         for (int face = 0; face < 6; face++)
         {
-            glUniform1i(uTexRotLoc, b.texRot[face]);
-            glUniform1i(uFlipXLoc, b.texFlipX[face] ? 1 : 0);
-            if (b.hasTex[face])
+            // face ȣ  (-Z, +Z, -X, +X, -Y, +Y)       
+            int n = (face < 2) ? 2 : (face < 4) ? 0 : 1;
+            int u = (n == 0) ? 2 : 0;
+            int v = (n == 1) ? 2 : 1;
+
+            int dimU = grid.GetDim(u);
+            int dimV = grid.GetDim(v);
+            std::vector<int> mask(dimU * dimV);
+
+            for (int slice = 0; slice < grid.GetDim(n); slice++)
             {
-                glUniform1i(uHasTexLoc, 1);
-                glActiveTexture(GL_TEXTURE0);
-                glBindTexture(GL_TEXTURE_2D, b.texID[face]);
-                glUniform1i(uTextureLoc, 0);
-
-                glActiveTexture(GL_TEXTURE1);
-                glBindTexture(GL_TEXTURE_2D, b.revealMask[face]);
-                glUniform1i(uRevealMaskLoc, 1);
+                // ĭ   ȣ + 1 (0 = ĥ  )
+                for (int cv = 0; cv < dimV; cv++)
+                {
+                    for (int cu = 0; cu < dimU; cu++)
+                    {
+                        int c[3];
+                        c[n] = slice;
+                        c[u] = cu;
+                        c[v] = cv;
+
+                        int bi = grid.GetCellBox(c[0], c[1], c[2]);
+                        const bool mergeable = bi >= 0 && bi < staticEnd
+                            && (boxes[bi].visibleFaces & (1 << face)) && !boxes[bi].hasTex[face];
+
+                        mask[cv * dimU + cu] = mergeable ? batchOf(boxes[bi].color) + 1 : 0;
+                        if (mergeable)
+                            mergedFaces[bi] |= (unsigned char)(1 << face);
+                    }
+                }
+
+                for (int cv = 0; cv < dimV; cv++)
+                {
+                    for (int cu = 0; cu < dimU; )
+                    {
+                        int m = mask[cv * dimU + cu];
+                        if (m == 0)
+                        {
+                            cu++;
+                            continue;
+                        }
+
+                        int width = 1;
+                        while (cu + width < dimU && mask[cv * dimU + cu + width] == m)
+                            width++;
+
+                        int height = 1;
+                        while (cv + height < dimV)
+                        {
+                            bool rowMatches = true;
+                            for (int k = 0; k < width && rowMatches; k++)
+                                rowMatches = mask[(cv + height) * dimU + cu + k] == m;
+                            if (!rowMatches)
+                                break;
+                            height++;
+                        }
+
+                        for (int dv = 0; dv < height; dv++)
+                            for (int k = 0; k < width; k++)
+                                mask[(cv + dv) * dimU + cu + k] = 0;
+
+                        int c0[3];
+                        int c1[3];
+                        c0[n] = c1[n] = slice;
+                        c0[u] = cu;
+                        c1[u] = cu + width - 1;
+                        c0[v] = cv;
+                        c1[v] = cv + height - 1;
+
+                        glm::vec3 minP = gridMin + glm::vec3(c0[0], c0[1], c0[2]) * cellSize;
+                        glm::vec3 maxP = gridMin + glm::vec3(c1[0] + 1, c1[1] + 1, c1[2] + 1) * cellSize;
+
+                        PendingQuad q;
+                        q.shape.pos = (minP + maxP) * 0.5f;
+                        q.shape.size = maxP - minP;
+                        q.face = face;
+                        q.batch = m - 1;
+                        q.cellX0 = c0[0];
+                        q.cellZ0 = c0[2];
+                        q.cellX1 = c1[0];
+                        q.cellZ1 = c1[2];
+                        pending.push_back(q);
+
+                        cu += width;
+                    }
+                }
             }
-            else
+        }
+    }
+
+    // ڿ    ڽ (overflow)  ؽó ִ  ϳ
+    std::vector<std::pair<int, int>> texturedFaces;
+
+    for (int i = 0; i < staticEnd; i++)
+    {
+        const Box& b = boxes[i];
+        for (int face = 0; face < 6; face++)
+        {
+            if (!(b.visibleFaces & (1 << face)) || (mergedFaces[i] & (1 << face)))
+                continue;
+
+            if (b.hasTex[face])
             {
-                glUniform1i(uHasTexLoc, 0);
+                texturedFaces.push_back({ i, face });
+                continue;
             }
 
-            glDrawElements(
-                GL_TRIANGLES,
-                6,
-                GL_UNSIGNED_INT,
-                (void*)(sizeof(unsigned int) * face * 6)
-            );
+            int cell = visibility.CellOf(b.pos);
+
+            PendingQuad q;
+            q.shape = b;
+            q.face = face;
+            q.batch = batchOf(b.color);
+            q.cellX0 = q.cellX1 = (cell >= 0) ? cell % visibility.GetWidth() : -1;
+            q.cellZ0 = q.cellZ1 = (cell >= 0) ? cell / visibility.GetWidth() : -1;
+            pending.push_back(q);
         }
     }
 
+    //   (z, x)  Ƽ ̿ ̴ 簢   ̾
+    std::stable_sort(pending.begin(), pending.end(), [](const PendingQuad& a, const PendingQuad& b)
+    {
+        if (a.batch != b.batch)
+            return a.batch < b.batch;
+        if (a.cellZ0 != b.cellZ0)
+            return a.cellZ0 < b.cellZ0;
+        return a.cellX0 < b.cellX0;
+    });
+
+    std::vector<float> vertices;
+    GLint vertexCount = 0;
+
+    for (const PendingQuad& q : pending)
+    {
+        staticBatches[q.batch].quads.push_back({ vertexCount, q.cellX0, q.cellZ0, q.cellX1, q.cellZ1 });
+        AppendFace(vertices, q.shape, q.face);
+        vertexCount += 6;
+    }
+
+    for (const std::pair<int, int>& f : texturedFaces)
+    {
+        staticTextured.push_back({ f.first, f.second, visibility.CellOf(boxes[f.first].pos), vertexCount });
+        AppendFace(vertices, boxes[f.first], f.second);
+        vertexCount += 6;
+    }
+
+    if (staticVao == 0)
+    {
+        glGenVertexArrays(1, &staticVao);
+        glGenBuffers(1, &staticVbo);
+    }
+
+    glBindVertexArray(staticVao);
+    glBindBuffer(GL_ARRAY_BUFFER, staticVbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+
+    // aPos
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, FLOATS_PER_VERTEX * sizeof(float), (void*)0);
+
+    // aNormal
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, FLOATS_PER_VERTEX * sizeof(float), (void*)(3 * sizeof(float)));
+
+    // aTexCoord
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, FLOATS_PER_VERTEX * sizeof(float), (void*)(6 * sizeof(float)));
+
     glBindVertexArray(0);
 }
 
@@ -128,35 +446,28 @@ void Map::InitFromArray(int w, int h, const int* data)
                 wall.size = glm::vec3(cellSize, wallHeight, cellSize);
                 wall.pos = glm::vec3(fx, wallHeight * 0.5f - 0.5f, fz);
                 wall.color = glm::vec3(0.1f, 0.1f, 0.1f);
-                for (int f = 0; f < 6; f++)
-                    CreateRevealMask(wall.revealMask[f]);
                 if (x == 1 && z == 22)
                 {
-                    wall.hasTex[3] = true;   // ʸ
-                    wall.texID[3] = TextureManager::Get("hint2");
+                    wall.SetFaceTexture(3, TextureManager::Get("hint2"));   // ʸ
                     wall.texFlipX[3] = true;
                 }
                 if (x == 7 && z == 12)
                 {
-                    wall.hasTex[0] = true;   // ޸ 
-                    wall.texID[0] = TextureManager::Get("hint1");
+                    wall.SetFaceTexture(0, TextureManager::Get("hint1"));   // ޸ 
                     wall.texFlipX[0] = true;
                 }
                 if (x == 6 && z == 30)
                 {
-                    wall.hasTex[0] = true;   // ޸ 
-                    wall.texID[0] = TextureManager::Get("rule");
+                    wall.SetFaceTexture(0, TextureManager::Get("rule"));   // ޸ 
                     wall.texFlipX[0] = true;
                 }
                 if (x == 13 && z == 5)
                 {
-                    wall.hasTex[2] = true;
-                    wall.texID[2] = TextureManager::Get("human");
+                    wall.SetFaceTexture(2, TextureManager::Get("human"));
                 }
                 if (x == 5 && z == 18)
                 {
-                    wall.hasTex[3] = true;
-                    wall.texID[3] = TextureManager::Get("help");
+                    wall.SetFaceTexture(3, TextureManager::Get("help"));
                     wall.texFlipX[3] = true;
                 }
                 boxes.push_back(wall);
@@ -165,17 +476,13 @@ void Map::InitFromArray(int w, int h, const int* data)
                 wall2.size = glm::vec3(cellSize, wallHeight, cellSize);
                 wall2.pos = glm::vec3(fx, wallHeight * 1.5f - 0.5f, fz);
                 wall2.color = glm::vec3(0.1f, 0.1f, 0.1f);
-                for (int f = 0; f < 6; f++)
-                    CreateRevealMask(wall2.revealMask[f]);
                 if (x == 5 && z == 5)
                 {
-                    wall2.hasTex[2] = true;   // ʸ
-                    wall2.texID[2] = TextureManager::Get("hint4");
+                    wall2.SetFaceTexture(2, TextureManager::Get("hint4"));   // ʸ
                 }
                 if (x == 6 && z == 30)
                 {
-                    wall2.hasTex[0] = true;   // ޸ 
-                    wall2.texID[0] = TextureManager::Get("project");
+                    wall2.SetFaceTexture(0, TextureManager::Get("project"));   // ޸ 
                     wall2.texFlipX[0] = true;
                 }
                 boxes.push_back(wall2);
@@ -187,12 +494,9 @@ void Map::InitFromArray(int w, int h, const int* data)
             ceiling.size = glm::vec3(cellSize, wallHeight, cellSize);
             ceiling.pos = glm::vec3(fx, wallHeight * 2.5f - 0.5f, fz);
             ceiling.color = glm::vec3(0.1f, 0.1f, 0.1f);
-            for (int f = 0; f < 6; f++)
-                CreateRevealMask(ceiling.revealMask[f]);
             if (x == 14 && z == 14)
             {
-                ceiling.hasTex[4] = true;
-                ceiling.texID[4] = TextureManager::Get("hint3");
+                ceiling.SetFaceTexture(4, TextureManager::Get("hint3"));
             }
             boxes.push_back(ceiling);
 
@@ -200,19 +504,15 @@ void Map::InitFromArray(int w, int h, const int* data)
             floor.size = glm::vec3(cellSize, wallHeight, cellSize);
             floor.pos = glm::vec3(fx, wallHeight * (-0.5f) - 0.5f, fz);
             floor.color = glm::vec3(0.1f, 0.1f, 0.1f);
-            for (int f = 0; f < 6; f++)
-                CreateRevealMask(floor.revealMask[f]);
 
             if (x == 6 && (z == 25||z == 26))
             {
-                floor.hasTex[5] = true;
-                floor.texID[5] = TextureManager::Get("footprint");
+                floor.SetFaceTexture(5, TextureManager::Get("footprint"));
                 floor.texRot[5] = 1;
             }
             if (x == 8 && (z == 2 || z == 3))
             {
-                floor.hasTex[5] = true;
-                floor.texID[5] = TextureManager::Get("footprint");
+                floor.SetFaceTexture(5, TextureManager::Get("footprint"));
                 floor.texRot[5] = 1;
             }
 
@@ -224,8 +524,6 @@ void Map::InitFromArray(int w, int h, const int* data)
                 ceiling.size = glm::vec3(cellSize, wallHeight, cellSize);
                 ceiling.pos = glm::vec3(fx, wallHeight * 1.5f - 0.5f, fz);
                 ceiling.color = glm::vec3(0.1f, 0.1f, 0.1f);
-                for (int f = 0; f < 6; f++)
-                    CreateRevealMask(ceiling.revealMask[f]);
                 boxes.push_back(ceiling);
             }
         }
@@ -243,13 +541,10 @@ void Map::InitFromArray(int w, int h, const int* data)
         door.pos = glm::vec3(fx, wallHeight * 0.5f - 0.5f, fz);
         door.color = glm::vec3(0.3f, 0.3f, 0.3f);
 
-        for (int f = 0; f < 6; f++) CreateRevealMask(door.revealMask[f]);
-
         doorIndex = boxes.size();
         if (doorMapX == 8 && doorMapZ == 1)
         {
-            door.hasTex[1] = true;   // ո(face=1)
-            door.texID[1] = TextureManager::Get("background");
+            door.SetFaceTexture(1, TextureManager::Get("background"));   // ո(face=1)
         }
         boxes.push_back(door);
     }
@@ -300,13 +595,10 @@ void Map::InitFromArray(int w, int h, const int* data)
 
                 key.pos = base + glm::vec3(ox, oy, 0.0f);
 
-                key.hasTex[1] = true;
-                key.texID[1] = TextureManager::Get("digit_" + std::to_string(k));
+                key.SetFaceTexture(1, TextureManager::Get("digit_" + std::to_string(k)));
 
                 key.color = glm::vec3(0.2f, 0.2f, 0.2f);
 
-                for (int f = 0; f < 6; f++) CreateRevealMask(key.revealMask[f]);
-
                 keypadDigits.push_back(k);
                 boxes.push_back(key);
             }
@@ -324,9 +616,77 @@ void Map::InitFromArray(int w, int h, const int* data)
         scareBox.pos = glm::vec3(0.0f, -9999.0f, 0.0f);
         scareBox.color = glm::vec3(1.0f, 1.0f, 1.0f);
 
-        scareBox.hasTex[1] = true;
-        CreateRevealMask(scareBox.revealMask[1]); 
+        // ո (1) ؽó main  ɾ ̺Ʈ   
         boxes.push_back(scareBox);
     }
+
+    // revealMask  ⼭  .   ϰ Lidar  ó ĥ   
+    revealPages.Reset((int)boxes.size());
+    boundsVersion++;
+
+    bvh.Build(boxes);
+    soa.Build(boxes);
+
+    //  ٴ /  / 2 / õ 4.   ̴ ڽ overflow 
+    grid.Init(
+        glm::vec3(-w / 2.0f * cellSize, -wallHeight - 0.5f, -h / 2.0f * cellSize),
+        glm::vec3(cellSize, wallHeight, cellSize),
+        w, 4, h);
+
+    for (int i = 0; i < (int)boxes.size(); i++)
+    {
+        if (i < doorIndex)
+            grid.Insert(i, boxes[i]);
+        else
+            grid.InsertOverflow(i);
+    }
+
+    ComputeFaceVisibility();
+
+    visibility.Build(w, h, data, glm::vec2(-w / 2.0f * cellSize, -h / 2.0f * cellSize), cellSize);
+    BuildStaticMesh();
+}
+
+void Map::ComputeFaceVisibility()
+{
+    // face ȣ  (-Z, +Z, -X, +X, -Y, +Y)    
+    static const int NEIGHBOR[6][3] =
+    {
+        {  0,  0, -1 },
+        {  0,  0,  1 },
+        { -1,  0,  0 },
+        {  1,  0,  0 },
+        {  0, -1,  0 },
+        {  0,  1,  0 },
+    };
+
+    for (Box& b : boxes)
+    {
+        b.visibleFaces = 0x3F;
+    }
+
+    //   ´ ڽ  ( / Űе / ɾ ڽ ̰ų  ۾Ƽ ׻ ̰ )
+    for (int y = 0; y < grid.GetDim(1); y++)
+    {
+        for (int z = 0; z < grid.GetDim(2); z++)
+        {
+            for (int x = 0; x < grid.GetDim(0); x++)
+            {
+                int bi = grid.GetCellBox(x, y, z);
+                if (bi < 0) continue;
+
+                for (int face = 0; face < 6; face++)
+                {
+                    int ni = grid.GetCellBox(
+                        x + NEIGHBOR[face][0],
+                        y + NEIGHBOR[face][1],
+                        z + NEIGHBOR[face][2]);
+
+                    if (ni >= 0)
+                        boxes[bi].visibleFaces &= ~(1 << face);
+                }
+            }
+        }
+    }
 }
 
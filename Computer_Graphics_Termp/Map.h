@@ -3,6 +3,12 @@
 #include <vector>
 #include <gl/glm/glm.hpp>
 #include <gl/glew.h>
+#include "BoxBvh.h"
+#include "GridIndex.h"
+#include "BoxSoA.h"
+#include "RevealMask.h"
+#include "BoxInstances.h"
+#include "CellVisibility.h"
 
 // ϳ ü
 struct Box
@@ -12,21 +18,26 @@ struct Box
     glm::vec3 color;
 
     bool     hasTex[6];
-    GLuint   texID[6];
-    GLuint revealMask[6];
+    int      texLayer[6];   // TextureManager ؽó 迭 ̾ (hasTex  鸸 ǹ )
 
     Box()
     {
         for (int i = 0; i < 6; i++)
         {
             hasTex[i] = false;
-            texID[i] = 0;
-            revealMask[i] = 0;
+            texLayer[i] = 0;
         }
     }
     int texRot[6] = { 0,0,0,0,0,0 };   // 0 = ȸ , 1 = 180 ȸ
+    unsigned char visibleFaces = 0x3F;  // 鸶 1Ʈ (1 << face).   ڽ    0
     bool texFlipX[6] = { false, false, false, false, false, false };
 
+    // 鿡 ؽó 迭 ̾ . layer  -1 (TextureManager   ̹) ̸ ؽó   
+    void SetFaceTexture(int face, int layer)
+    {
+        hasTex[face] = (layer >= 0);
+        texLayer[face] = (layer >= 0) ? layer : 0;
+    }
 };
 
 class Map
@@ -44,22 +55,28 @@ public:
         return boxes;
     }
 
-    //  ׸
+    //  ׸ ( ڽ ĵ ޽  ,  / Űе / ɾ ڽ vaoCube νϽ)
+    //  ޽ ī޶    ִ  (GetVisibility) ͸ ׸
+    // ó θ  vaoCube  νϽ Ӽ 
     void Draw(
         GLuint shaderProgram,
         GLuint vaoCube,
         GLint uModelLoc,
-        GLint uViewLoc,
-        GLint uProjLoc,
+        GLint uNormalMatLoc,
+        GLint uViewProjLoc,
         GLint uColorLoc,
         GLint uTexRotLoc,
         GLint uHasTexLoc,
         GLint uTextureLoc,
         GLint uRevealMaskLoc,
+        GLint uRevealLayerLoc,
         GLint uFlipXLoc,
+        GLint uTexLayerLoc,
+        GLint uInstancedLoc,
+        GLint uMaterialLoc,
         const glm::mat4& view,
         const glm::mat4& proj
-    ) const;
+    );
 
     // 2D 迭 3D  ϴ Լ
     void InitFromArray(int w, int h, const int* data);
@@ -72,6 +89,107 @@ public:
         return boxes;
     }
 
+    // ĳƮ ӿ BVH (InitFromArray  )
+    const BoxBvh& GetBvh() const
+    {
+        return bvh;
+    }
+
+    //   ε (DDA ĳƮ). ̴ ڽ overflow  ־ Refit  ʿ 
+    const GridIndex& GetGrid() const
+    {
+        return grid;
+    }
+
+    //    ִ  (PVS). Map::Draw  Lidar  ׸Ⱑ  
+    const CellVisibility& GetVisibility() const
+    {
+        return visibility;
+    }
+
+    // ڽ min / max  Ƶ SoA 纻 (SIMD  ׽Ʈ)
+    const BoxSoA& GetBoxSoA() const
+    {
+        return soa;
+    }
+
+    // 鸶 revealMask  / ؽó 迭  (GetFaceSlot(ڽ ε, ))
+    const RevealMaskPages& GetRevealPages() const
+    {
+        return revealPages;
+    }
+
+    // Lidar  ó ĥϴ 鿡   
+    RevealMaskPages& GetRevealPagesMutable()
+    {
+        return revealPages;
+    }
+
+    // GetBoxesMutable()  ڽ ġ / ũ⸦ ٲ ĳƮ  ȣؾ 
+    // (BVH   SoA 纻 ٽ )
+    void UpdateBoxBounds()
+    {
+        bvh.Refit(boxes);
+        soa.Update(boxes);
+        boundsVersion++;
+    }
+
+    // InitFromArray / UpdateBoxBounds   (Lidar  ĵ    ϴ  )
+    unsigned int GetBoundsVersion() const
+    {
+        return boundsVersion;
+    }
+
 private:
     std::vector<Box> boxes;
+    BoxBvh bvh;
+    GridIndex grid;
+    BoxSoA soa;
+    RevealMaskPages revealPages;
+    CellVisibility visibility;
+    unsigned int boundsVersion = 0;
+
+    //  ڽ (doorIndex )  ̴   ǥ  ޽
+    //   ť  (pos, normal, uv). texRot / texFlipX  uv  ̸ ݿ
+    // ؽó   򺰷  ʿ, ؽó ִ  ʿ 6 
+    // ؽó     /   ִ 簢 ģ 簢 (greedy meshing)
+    //   ȿ   Ƽ ̴ 簢    Ǵ   
+    struct StaticQuad
+    {
+        GLint first;
+        int cellX0, cellZ0;     // 簢 ģ XZ   ( ̸ cellX0 = -1 ̶ ׻ ׸)
+        int cellX1, cellZ1;
+    };
+
+    struct StaticColorBatch
+    {
+        glm::vec3 color;
+        std::vector<StaticQuad> quads;
+    };
+
+    struct StaticTexturedFace
+    {
+        int boxIndex;
+        int face;
+        int cell;       //  ̸ -1
+        GLint first;
+    };
+
+    GLuint staticVao = 0;
+    GLuint staticVbo = 0;
+    std::vector<StaticColorBatch> staticBatches;
+    std::vector<StaticTexturedFace> staticTextured;
+
+    // glMultiDrawArrays  ѱ  (  ٽ ä)
+    std::vector<GLint> drawFirsts;
+    std::vector<GLsizei> drawCounts;
+
+    // InitFromArray  (visibleFaces  ) ȣ
+    void BuildStaticMesh();
+
+    // ̴ ڽ (doorIndex  ) νϽ.   ٲ ڵ常 ٽ ø
+    BoxInstanceBuffer dynamicInstances;
+
+    //   ´  ãƼ visibleFaces   (grid  ä  ȣ)
+    void ComputeFaceVisibility();
 };
@@ -0,0 +1,451 @@
+#include "PointCloud.h"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <gl/glm/gtc/matrix_transform.hpp>
+#include <gl/glm/gtc/type_ptr.hpp>
+
+namespace
+{
+    // ī޶󿡼 ûũ AABB  Ÿ   ĭ ǳʶٸ ׸
+    const float LOD_NEAR = 24.0f;   //   
+    const float LOD_FAR = 48.0f;    //   2ĭ,  4ĭ
+
+    // ûũ 迡  ģ  /      ߸ ʰ ȭ   ø
+    const float QUANT_MARGIN = 2.0f;
+
+    // LOD ε  ȿ ݺ  ġ ( )
+    const int LOD2_OFFSET = 0;
+    const int LOD4_OFFSET = POINT_BLOCK_SIZE / 2;
+
+    // proj * view    6 ̱ (ax + by + cz + d >= 0  )
+    void ExtractFrustumPlanes(const glm::mat4& m, glm::vec4 planes[6])
+    {
+        glm::vec4 r0(m[0][0], m[1][0], m[2][0], m[3][0]);
+        glm::vec4 r1(m[0][1], m[1][1], m[2][1], m[3][1]);
+        glm::vec4 r2(m[0][2], m[1][2], m[2][2], m[3][2]);
+        glm::vec4 r3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+        planes[0] = r3 + r0;
+        planes[1] = r3 - r0;
+        planes[2] = r3 + r1;
+        planes[3] = r3 - r1;
+        planes[4] = r3 + r2;
+        planes[5] = r3 - r2;
+    }
+
+    bool AabbOutside(const glm::vec4 planes[6], const glm::vec3& bmin, const glm::vec3& bmax)
+    {
+        for (int i = 0; i < 6; i++)
+        {
+            const glm::vec4& pl = planes[i];
+
+            //     Ƣ  ٱ̸ AABB ü ٱ
+            glm::vec3 v(
+                pl.x >= 0.0f ? bmax.x : bmin.x,
+                pl.y >= 0.0f ? bmax.y : bmin.y,
+                pl.z >= 0.0f ? bmax.z : bmin.z);
+
+            if (pl.x * v.x + pl.y * v.y + pl.z * v.z + pl.w < 0.0f)
+                return true;
+        }
+        return false;
+    }
+}
+
+PointCloud::PointCloud(std::size_t capacity)
+{
+    std::size_t blockCount = (capacity + POINT_BLOCK_SIZE - 1) / POINT_BLOCK_SIZE;
+    if (blockCount == 0)
+        blockCount = 1;
+
+    data.resize(blockCount * POINT_BLOCK_SIZE);
+    stamps.resize(blockCount * POINT_BLOCK_SIZE);
+    surfaces.resize(blockCount * POINT_BLOCK_SIZE, -1);
+    blocks.resize(blockCount);
+
+    chunks.resize(1);
+    SetupChunkQuant();
+    Clear();
+}
+
+PointCloud::~PointCloud()
+{
+    if (vbo != 0)
+    {
+        if (mapped != nullptr)
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, vbo);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+        }
+        glDeleteBuffers(1, &vbo);
+    }
+    if (stampVbo != 0)
+    {
+        if (mappedStamps != nullptr)
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, stampVbo);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+        }
+        glDeleteBuffers(1, &stampVbo);
+    }
+    if (lodEbo != 0)
+    {
+        glDeleteBuffers(1, &lodEbo);
+    }
+}
+
+void PointCloud::Init()
+{
+    //  ûũ ε: [0, 2, 4, ...]  [0, 4, 8, ...].   base vertex  ѱ
+    std::vector<GLuint> lodIndices(POINT_BLOCK_SIZE / 2 + POINT_BLOCK_SIZE / 4);
+    for (int i = 0; i < POINT_BLOCK_SIZE / 2; i++)
+        lodIndices[LOD2_OFFSET + i] = i * 2;
+    for (int i = 0; i < POINT_BLOCK_SIZE / 4; i++)
+        lodIndices[LOD4_OFFSET + i] = i * 4;
+
+    glGenBuffers(1, &lodEbo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, lodEbo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * lodIndices.size(), lodIndices.data(), GL_STATIC_DRAW);
+
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+    GLsizeiptr bytes = sizeof(PackedPoint) * data.size();
+    GLsizeiptr stampBytes = sizeof(float) * stamps.size();
+
+    //   صΰ  . COHERENT   flush  ص  draw  
+    // (  draw     а   ,       ٲ  潺  )
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    if (GLEW_ARB_buffer_storage)
+    {
+        glBufferStorage(GL_ARRAY_BUFFER, bytes, nullptr, flags);
+        mapped = static_cast<PackedPoint*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes, flags));
+    }
+
+    if (mapped == nullptr)
+    {
+        glBufferData(GL_ARRAY_BUFFER, bytes, nullptr, GL_DYNAMIC_DRAW);
+    }
+
+    // 0 ~ 65535 -> 0 ~ 1  ȭؼ ѱ ( ǥ Draw  uModel )
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedPoint), (void*)0);
+
+    //  ð    (ġ Ʈ 6Ʈ ״ η)
+    glGenBuffers(1, &stampVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, stampVbo);
+
+    if (GLEW_ARB_buffer_storage)
+    {
+        glBufferStorage(GL_ARRAY_BUFFER, stampBytes, nullptr, flags);
+        mappedStamps = static_cast<float*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, stampBytes, flags));
+    }
+
+    if (mappedStamps == nullptr)
+    {
+        glBufferData(GL_ARRAY_BUFFER, stampBytes, nullptr, GL_DYNAMIC_DRAW);
+    }
+
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)0);
+}
+
+void PointCloud::SetChunkGrid(const glm::vec3& origin, float sizeX, float sizeZ, float height, int nx, int nz)
+{
+    gridOrigin = origin;
+    chunkSize[0] = sizeX;
+    chunkSize[1] = sizeZ;
+    chunkDims[0] = std::max(nx, 1);
+    chunkDims[1] = std::max(nz, 1);
+
+    //    ̾ uModel   ̶   Ʋ
+    quantExtent = std::max(std::max(sizeX, sizeZ), height) + QUANT_MARGIN * 2.0f;
+
+    chunks.assign(chunkDims[0] * chunkDims[1], Chunk());
+    SetupChunkQuant();
+    Clear();
+}
+
+void PointCloud::SetupChunkQuant()
+{
+    for (int cz = 0; cz < chunkDims[1]; cz++)
+    {
+        for (int cx = 0; cx < chunkDims[0]; cx++)
+        {
+            glm::vec3 cmin(
+                gridOrigin.x + cx * chunkSize[0],
+                gridOrigin.y,
+                gridOrigin.z + cz * chunkSize[1]);
+
+            chunks[cz * chunkDims[0] + cx].quantOrigin = cmin - glm::vec3(QUANT_MARGIN);
+        }
+    }
+}
+
+PackedPoint PointCloud::Encode(const Chunk& c, const glm::vec3& p) const
+{
+    glm::vec3 t = (p - c.quantOrigin) * (65535.0f / quantExtent);
+    t = glm::clamp(t + 0.5f, glm::vec3(0.0f), glm::vec3(65535.0f));
+
+    PackedPoint q;
+    q.x = (std::uint16_t)t.x;
+    q.y = (std::uint16_t)t.y;
+    q.z = (std::uint16_t)t.z;
+    return q;
+}
+
+int PointCloud::ChunkOf(const glm::vec3& p) const
+{
+    //    ڸ ûũ (AABB    þϱ ø )
+    int cx = (int)std::floor((p.x - gridOrigin.x) / chunkSize[0]);
+    int cz = (int)std::floor((p.z - gridOrigin.z) / chunkSize[1]);
+    cx = std::min(std::max(cx, 0), chunkDims[0] - 1);
+    cz = std::min(std::max(cz, 0), chunkDims[1] - 1);
+    return cz * chunkDims[0] + cx;
+}
+
+void PointCloud::Clear()
+{
+    for (Block& b : blocks)
+    {
+        b.chunk = -1;
+        b.count = 0;
+        b.generation++;
+        b.dirtyLo = POINT_BLOCK_SIZE;
+        b.dirtyHi = 0;
+    }
+
+    freeBlocks.clear();
+    for (int i = (int)blocks.size() - 1; i >= 0; i--)
+        freeBlocks.push_back(i);
+
+    for (Chunk& c : chunks)
+    {
+        c.blocks.clear();
+        c.pointCount = 0;
+    }
+
+    dirtyBlocks.clear();
+    count = 0;
+}
+
+void PointCloud::ReleaseBlock(int bi)
+{
+    Block& b = blocks[bi];
+
+    Chunk& c = chunks[b.chunk];
+    c.blocks.erase(std::find(c.blocks.begin(), c.blocks.end(), bi));
+    c.pointCount -= b.count;
+
+    count -= b.count;
+
+    b.chunk = -1;
+    b.count = 0;
+    b.generation++;
+    b.dirtyLo = POINT_BLOCK_SIZE;
+    b.dirtyHi = 0;
+}
+
+int PointCloud::AcquireBlock(int chunk)
+{
+    int bi;
+
+    if (!freeBlocks.empty())
+    {
+        bi = freeBlocks.back();
+        freeBlocks.pop_back();
+    }
+    else
+    {
+        //        
+        bi = 0;
+        for (int i = 1; i < (int)blocks.size(); i++)
+        {
+            if (blocks[i].birth < blocks[bi].birth)
+                bi = i;
+        }
+        ReleaseBlock(bi);
+    }
+
+    Block& b = blocks[bi];
+    b.chunk = chunk;
+    b.birth = ++birthClock;
+
+    chunks[chunk].blocks.push_back(bi);
+    return bi;
+}
+
+std::uint64_t PointCloud::Push(const glm::vec3& p, float stamp, int surface)
+{
+    int ci = ChunkOf(p);
+
+    int bi = chunks[ci].blocks.empty() ? -1 : chunks[ci].blocks.back();
+    if (bi < 0 || blocks[bi].count == POINT_BLOCK_SIZE)
+        bi = AcquireBlock(ci);
+
+    Chunk& c = chunks[ci];
+    Block& b = blocks[bi];
+
+    int local = b.count;
+    std::size_t index = (std::size_t)bi * POINT_BLOCK_SIZE + local;
+    data[index] = Encode(c, p);
+    stamps[index] = stamp;
+    surfaces[index] = surface;
+
+    b.newest = (local == 0) ? stamp : std::max(b.newest, stamp);
+    b.count++;
+    c.pointCount++;
+    count++;
+
+    if (b.dirtyLo >= b.dirtyHi)
+    {
+        dirtyBlocks.push_back(bi);
+        b.dirtyLo = local;
+    }
+    b.dirtyHi = local + 1;
+
+    if (c.pointCount == 1)
+    {
+        c.bmin = p;
+        c.bmax = p;
+    }
+    else
+    {
+        c.bmin = glm::min(c.bmin, p);
+        c.bmax = glm::max(c.bmax, p);
+    }
+
+    return ((std::uint64_t)b.generation << 32) | (std::uint64_t)index;
+}
+
+void PointCloud::ReleaseExpired(float before)
+{
+    for (int bi = 0; bi < (int)blocks.size(); bi++)
+    {
+        const Block& b = blocks[bi];
+        if (b.chunk < 0 || b.count == 0 || b.newest >= before)
+            continue;
+
+        ReleaseBlock(bi);
+        freeBlocks.push_back(bi);
+    }
+}
+
+bool PointCloud::IsAlive(std::uint64_t handle) const
+{
+    std::size_t index = (std::size_t)(handle & 0xFFFFFFFFu);
+    std::uint32_t generation = (std::uint32_t)(handle >> 32);
+
+    std::size_t bi = index / POINT_BLOCK_SIZE;
+    if (bi >= blocks.size())
+        return false;
+
+    const Block& b = blocks[bi];
+    return b.generation == generation && (int)(index % POINT_BLOCK_SIZE) < b.count;
+}
+
+void PointCloud::Upload()
+{
+    if (dirtyBlocks.empty() || vbo == 0)
+        return;
+
+    for (int bi : dirtyBlocks)
+    {
+        Block& b = blocks[bi];
+        if (b.dirtyLo >= b.dirtyHi)
+            continue;
+
+        std::size_t first = (std::size_t)bi * POINT_BLOCK_SIZE + b.dirtyLo;
+        std::size_t n = b.dirtyHi - b.dirtyLo;
+
+        if (mapped != nullptr)
+        {
+            std::memcpy(mapped + first, &data[first], sizeof(PackedPoint) * n);
+        }
+        else
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, vbo);
+            glBufferSubData(GL_ARRAY_BUFFER,
+                sizeof(PackedPoint) * first,
+                sizeof(PackedPoint) * n,
+                &data[first]);
+        }
+
+        if (mappedStamps != nullptr)
+        {
+            std::memcpy(mappedStamps + first, &stamps[first], sizeof(float) * n);
+        }
+        else
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, stampVbo);
+            glBufferSubData(GL_ARRAY_BUFFER,
+                sizeof(float) * first,
+                sizeof(float) * n,
+                &stamps[first]);
+        }
+
+        b.dirtyLo = POINT_BLOCK_SIZE;
+        b.dirtyHi = 0;
+    }
+
+    dirtyBlocks.clear();
+}
+
+void PointCloud::Draw(const glm::mat4& viewProj, const glm::vec3& cameraPos, GLint uModelLoc,
+    const std::vector<unsigned char>& chunkVisible) const
+{
+    if (count == 0)
+        return;
+
+    glm::vec4 planes[6];
+    ExtractFrustumPlanes(viewProj, planes);
+
+    for (std::size_t ci = 0; ci < chunks.size(); ci++)
+    {
+        const Chunk& c = chunks[ci];
+        if (c.pointCount == 0)
+            continue;
+
+        // ̷  ʸ ûũ (Map   ü)
+        if (ci < chunkVisible.size() && !chunkVisible[ci])
+            continue;
+
+        if (AabbOutside(planes, c.bmin, c.bmax))
+            continue;
+
+        // ī޶󿡼 AABB    Ÿ
+        glm::vec3 d = glm::max(glm::max(c.bmin - cameraPos, cameraPos - c.bmax), glm::vec3(0.0f));
+        float dist = glm::length(d);
+
+        int stride = (dist < LOD_NEAR) ? 1 : (dist < LOD_FAR ? 2 : 4);
+        int lodOffset = (stride == 2) ? LOD2_OFFSET : LOD4_OFFSET;
+
+        // ȭ [0, 1]  ->  ǥ
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), c.quantOrigin);
+        model = glm::scale(model, glm::vec3(quantExtent));
+        glUniformMatrix4fv(uModelLoc, 1, GL_FALSE, glm::value_ptr(model));
+
+        for (int bi : c.blocks)
+        {
+            int n = blocks[bi].count;
+            GLint base = bi * POINT_BLOCK_SIZE;
+
+            if (stride == 1)
+            {
+                glDrawArrays(GL_POINTS, base, n);
+            }
+            else
+            {
+                int m = n / stride;
+                if (m == 0)
+                    continue;
+
+                glDrawElementsBaseVertex(GL_POINTS, m, GL_UNSIGNED_INT,
+                    (void*)(sizeof(GLuint) * lodOffset), base);
+            }
+        }
+    }
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include <gl/glew.h>
+#include <gl/glm/glm.hpp>
+
+//  ϳ    (VBO ȿ     )
+const int POINT_BLOCK_SIZE = 1024;
+
+// ȭ  ϳ (6Ʈ, vec3  )
+// ûũ   0 ~ 65535 Ҽ .  ̴ ȭ [0, 1]  
+// Draw  ûũ uModel = translate() * scale()  Ѱܼ vertex.glsl   ǥ Ǯ
+struct PackedPoint
+{
+    std::uint16_t x, y, z;
+};
+
+// ̴ Ʈ Ŭ
+//  ڿ  XZ ûũ  , ûũ VBO   ũ    ޾Ƽ 
+// ׸ ûũ AABB  proj * view  ߶󳻰,  ûũ ε ۷ 2 / 4 ĭ ǳʶٸ ׸
+//        °   (  )
+// ARB_buffer_storage   VBO   (persistent map)ؼ    ٷ 
+//  RAM / VBO   PackedPoint    (ûũ 8 x 16 x 8    ĭ 0.3mm)
+//   ð()  VBO ϳ float   3 Ӽ(aCaptureTime) ѱ
+//    ̴  , CPU         ϸ ° 
+class PointCloud
+{
+public:
+    explicit PointCloud(std::size_t capacity);
+    ~PointCloud();
+
+    PointCloud(const PointCloud&) = delete;
+    PointCloud& operator=(const PointCloud&) = delete;
+
+    // VBO + LOD ε  .  ׸ VAO  ε ¿ θ 
+    // 0 Ӽ(aPos) ȭ unsigned short 3, 3 Ӽ(aCaptureTime) float ϳ ص
+    void Init();
+
+    // ûũ  (origin =  ּ 𼭸, ûũ  ĭ XZ ũ, ü , ).    
+    void SetChunkGrid(const glm::vec3& origin, float chunkSizeX, float chunkSizeZ, float height, int nx, int nz);
+
+    //  ߰ (stamp =  ð,  / surface = ڽ * 6 + , 𸣸 -1)
+    // ִ ڵ IsAlive    
+    std::uint64_t Push(const glm::vec3& p, float stamp, int surface);
+
+    //    before      (    ƴ϶  ŭ )
+    void ReleaseExpired(float before);
+
+    // ڵ    ִ ( ưų Clear  false)
+    bool IsAlive(std::uint64_t handle) const;
+
+    void Clear();
+
+    std::size_t Size() const
+    {
+        return count;
+    }
+
+    std::size_t Capacity() const
+    {
+        return blocks.size() * POINT_BLOCK_SIZE;
+    }
+
+    //  ִ   ( ûũ /  )
+    template <typename Func>
+    void ForEachPoint(Func func) const
+    {
+        for (std::size_t bi = 0; bi < blocks.size(); bi++)
+        {
+            if (blocks[bi].count == 0)
+                continue;
+
+            const Chunk& c = chunks[blocks[bi].chunk];
+            const PackedPoint* first = &data[bi * POINT_BLOCK_SIZE];
+            for (int i = 0; i < blocks[bi].count; i++)
+                func(Decode(c, first[i]));
+        }
+    }
+
+    int GetBlockCount() const
+    {
+        return (int)blocks.size();
+    }
+
+    //    ٲ ȣ /     ( ӿ      з )
+    std::uint32_t GetBlockGeneration(int block) const
+    {
+        return blocks[block].generation;
+    }
+
+    int GetBlockPointCount(int block) const
+    {
+        return blocks[block].count;
+    }
+
+    //  ϳ  . func(ġ,  ð, surface) (ó  Ͼ   )
+    template <typename Func>
+    void ForEachPointInBlock(int block, Func func) const
+    {
+        const Block& b = blocks[block];
+        if (b.count == 0)
+            return;
+
+        const Chunk& c = chunks[b.chunk];
+        std::size_t first = (std::size_t)block * POINT_BLOCK_SIZE;
+        for (int i = 0; i < b.count; i++)
+            func(Decode(c, data[first + i]), stamps[first + i], surfaces[first + i]);
+    }
+
+    //    GPU . GL 忡
+    void Upload();
+
+    // VAO  ε ¿. ̴ ûũ Ÿ  ׸
+    // chunkVisible     (ûũ z * nx + x ) 0  ûũ ü ˻  ǳʶ
+    // ûũ uModelLoc  ȭ Ǯ  
+    void Draw(const glm::mat4& viewProj, const glm::vec3& cameraPos, GLint uModelLoc,
+        const std::vector<unsigned char>& chunkVisible) const;
+
+private:
+    struct Block
+    {
+        int chunk = -1;             //  ûũ (-1 =  )
+        int count = 0;
+        std::uint32_t generation = 0;   //    (ڵ ȿ ˻)
+        std::uint64_t birth = 0;        // ûũ   ( )
+        float newest = 0.0f;            //  ȿ  ʰ   ð
+
+        int dirtyLo = POINT_BLOCK_SIZE; //   ø  [dirtyLo, dirtyHi)
+        int dirtyHi = 0;
+    };
+
+    struct Chunk
+    {
+        std::vector<int> blocks;    //  ,  Ͽ ̾ 
+        int pointCount = 0;
+        glm::vec3 bmin = glm::vec3(0.0f);
+        glm::vec3 bmax = glm::vec3(0.0f);
+        glm::vec3 quantOrigin = glm::vec3(0.0f);    // ȭ  (ûũ ּ 𼭸 - QUANT_MARGIN)
+    };
+
+    std::vector<PackedPoint> data;
+    std::vector<float> stamps;      // data   ε   ð
+    std::vector<std::int32_t> surfaces; //   ڽ * 6 +  (CPU , )
+    std::vector<Block> blocks;
+    std::vector<int> freeBlocks;
+    std::vector<int> dirtyBlocks;
+    std::vector<Chunk> chunks;
+
+    // ڸ    ֺ 1024  ť ϳ ( ĭ 1.6cm)
+    glm::vec3 gridOrigin = glm::vec3(-512.0f);
+    float chunkSize[2] = { 1024.0f, 1024.0f };
+    int chunkDims[2] = { 1, 1 };
+    float quantExtent = 1024.0f;    // ûũ ȭ    (  , 65535 ĭ)
+
+    std::size_t count = 0;
+    std::uint64_t birthClock = 0;
+
+    GLuint vbo = 0;
+    GLuint stampVbo = 0;
+    GLuint lodEbo = 0;
+    PackedPoint* mapped = nullptr;  //    (  nullptr)
+    float* mappedStamps = nullptr;
+
+    int ChunkOf(const glm::vec3& p) const;
+    void SetupChunkQuant();
+    PackedPoint Encode(const Chunk& c, const glm::vec3& p) const;
+
+    glm::vec3 Decode(const Chunk& c, const PackedPoint& q) const
+    {
+        return c.quantOrigin + glm::vec3(q.x, q.y, q.z) * (quantExtent / 65535.0f);
+    }
+    int AcquireBlock(int chunk);
+    void ReleaseBlock(int block);
+};
@@ -0,0 +1,288 @@
+#include "PointExport.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+
+namespace
+{
+    template <typename T>
+    void Put(std::vector<unsigned char>& bytes, T v)
+    {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(&v);
+        bytes.insert(bytes.end(), p, p + sizeof(T));
+    }
+
+    //   ڿ ( ĭ 0)
+    void PutText(std::vector<unsigned char>& bytes, const char* text, std::size_t length)
+    {
+        std::size_t n = std::min(std::strlen(text), length);
+        bytes.insert(bytes.end(), text, text + n);
+        bytes.insert(bytes.end(), length - n, 0);
+    }
+
+    void PutZeros(std::vector<unsigned char>& bytes, std::size_t length)
+    {
+        bytes.insert(bytes.end(), length, 0);
+    }
+
+    // LAS 1.4  
+    const std::uint16_t LAS_HEADER_SIZE = 375;
+    const std::uint16_t LAS_VLR_HEADER_SIZE = 54;
+    const std::uint16_t LAS_EXTRA_BYTES_DESC = 192;
+    const std::uint8_t  LAS_POINT_FORMAT = 6;
+    const std::uint16_t LAS_POINT_SIZE = 30 + 4 + 1;    //  6 + extra bytes (int32 box, int8 face)
+    const double LAS_SCALE = 0.001;                     // 1mm
+
+    //  ȿ ߿ ä ĭ ġ
+    const long LAS_BOUNDS_OFFSET = 179;         // max x, min x, max y, min y, max z, min z (double)
+    const long LAS_POINT_COUNT_OFFSET = 247;    // uint64  ,   return    [15]
+
+    // extra bytes  ϳ (LAS 1.4 R15 ǥ 24)
+    void PutExtraBytesDesc(std::vector<unsigned char>& bytes, std::uint8_t dataType, const char* name, const char* description)
+    {
+        PutZeros(bytes, 2);                 // reserved
+        Put<std::uint8_t>(bytes, dataType);
+        Put<std::uint8_t>(bytes, 0);        // options (no_data / min / max / scale / offset  )
+        PutText(bytes, name, 32);
+        PutZeros(bytes, 4);                 // unused
+        PutZeros(bytes, 24 * 5);            // no_data, min, max, scale, offset
+        PutText(bytes, description, 32);
+    }
+}
+
+PointExporter::~PointExporter()
+{
+    End();
+    Join();
+}
+
+void PointExporter::Join()
+{
+    if (thread.joinable())
+        thread.join();
+}
+
+bool PointExporter::Begin(const std::string& path, PointExportFormat exportFormat)
+{
+    End();
+    Join();
+
+    file = fopen(path.c_str(), "wb");
+    if (file == nullptr)
+        return false;
+
+    format = exportFormat;
+    written.store(0);
+    for (int i = 0; i < 3; i++)
+    {
+        bmin[i] = 0.0;
+        bmax[i] = 0.0;
+    }
+
+    WriteHeader();
+
+    pending.clear();
+    ending = false;
+    thread = std::thread(&PointExporter::Run, this);
+    return true;
+}
+
+bool PointExporter::CanAccept()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return thread.joinable() && !ending && pending.size() < MAX_PENDING;
+}
+
+void PointExporter::Submit(std::vector<ExportPoint>&& chunk)
+{
+    if (chunk.empty())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (ending)
+            return;
+        pending.push_back(std::move(chunk));
+    }
+    cv.notify_one();
+}
+
+void PointExporter::End()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ending = true;
+    }
+    cv.notify_one();
+}
+
+void PointExporter::Run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        cv.wait(lock, [&] { return ending || !pending.empty(); });
+
+        if (pending.empty())
+            break;
+
+        std::vector<ExportPoint> chunk = std::move(pending.front());
+        pending.pop_front();
+
+        lock.unlock();
+        WriteChunk(chunk);
+        lock.lock();
+    }
+    lock.unlock();
+
+    PatchHeader();
+    fclose(file);
+    file = nullptr;
+}
+
+void PointExporter::WriteHeader()
+{
+    bytes.clear();
+
+    if (format == PointExportFormat::Ply)
+    {
+        //      ְ 10ڸ 
+        const char* head =
+            "ply\n"
+            "format binary_little_endian 1.0\n"
+            "comment lidar point cloud (time = capture time in seconds, box / face = hit surface, -1 = unknown)\n"
+            "element vertex ";
+        const char* tail =
+            "property float x\n"
+            "property float y\n"
+            "property float z\n"
+            "property float time\n"
+            "property int box\n"
+            "property char face\n"
+            "end_header\n";
+
+        fputs(head, file);
+        plyCountOffset = ftell(file);
+        fprintf(file, "%010llu\n", 0ULL);
+        fputs(tail, file);
+        return;
+    }
+
+    std::time_t now = std::time(nullptr);
+    std::tm* date = std::localtime(&now);
+
+    const std::uint32_t pointOffset = LAS_HEADER_SIZE + LAS_VLR_HEADER_SIZE + 2 * LAS_EXTRA_BYTES_DESC;
+
+    PutText(bytes, "LASF", 4);
+    Put<std::uint16_t>(bytes, 0);           // file source id
+    Put<std::uint16_t>(bytes, 0x10);        // global encoding (WKT Ʈ,  6 ̻ ʼ)
+    PutZeros(bytes, 16);                    // project GUID
+    Put<std::uint8_t>(bytes, 1);
+    Put<std::uint8_t>(bytes, 4);
+    PutText(bytes, "LIDAR SCAN", 32);
+    PutText(bytes, "Computer_Graphics_Termp", 32);
+    Put<std::uint16_t>(bytes, (std::uint16_t)(date ? date->tm_yday + 1 : 1));
+    Put<std::uint16_t>(bytes, (std::uint16_t)(date ? date->tm_year + 1900 : 2000));
+    Put<std::uint16_t>(bytes, LAS_HEADER_SIZE);
+    Put<std::uint32_t>(bytes, pointOffset);
+    Put<std::uint32_t>(bytes, 1);           // VLR 
+    Put<std::uint8_t>(bytes, LAS_POINT_FORMAT);
+    Put<std::uint16_t>(bytes, LAS_POINT_SIZE);
+    Put<std::uint32_t>(bytes, 0);           // legacy   ( 6 ̻ 0)
+    PutZeros(bytes, 4 * 5);                 // legacy return   
+    for (int i = 0; i < 3; i++) Put<double>(bytes, LAS_SCALE);
+    for (int i = 0; i < 3; i++) Put<double>(bytes, 0.0);
+    PutZeros(bytes, 8 * 6);                 //  (PatchHeader)
+    Put<std::uint64_t>(bytes, 0);           // waveform
+    Put<std::uint64_t>(bytes, 0);           // ù EVLR
+    Put<std::uint32_t>(bytes, 0);           // EVLR 
+    Put<std::uint64_t>(bytes, 0);           //   (PatchHeader)
+    PutZeros(bytes, 8 * 15);                // return    (PatchHeader)
+
+    // extra bytes VLR:  ڿ box (int32), face (int8)
+    Put<std::uint16_t>(bytes, 0);
+    PutText(bytes, "LASF_Spec", 16);
+    Put<std::uint16_t>(bytes, 4);
+    Put<std::uint16_t>(bytes, 2 * LAS_EXTRA_BYTES_DESC);
+    PutText(bytes, "Extra Bytes", 32);
+    PutExtraBytesDesc(bytes, 6, "box", "hit box index (-1 = unknown)");
+    PutExtraBytesDesc(bytes, 2, "face", "hit face -Z +Z -X +X -Y +Y");
+
+    fwrite(bytes.data(), 1, bytes.size(), file);
+}
+
+void PointExporter::WriteChunk(const std::vector<ExportPoint>& chunk)
+{
+    bytes.clear();
+
+    std::uint64_t before = written.load();
+    bool first = (before == 0);
+
+    for (const ExportPoint& p : chunk)
+    {
+        const double pos[3] = { p.pos.x, p.pos.y, p.pos.z };
+        for (int i = 0; i < 3; i++)
+        {
+            bmin[i] = first ? pos[i] : std::min(bmin[i], pos[i]);
+            bmax[i] = first ? pos[i] : std::max(bmax[i], pos[i]);
+        }
+        first = false;
+
+        if (format == PointExportFormat::Ply)
+        {
+            Put<float>(bytes, p.pos.x);
+            Put<float>(bytes, p.pos.y);
+            Put<float>(bytes, p.pos.z);
+            Put<float>(bytes, p.time);
+            Put<std::int32_t>(bytes, p.boxIndex);
+            Put<std::int8_t>(bytes, (std::int8_t)p.face);
+            continue;
+        }
+
+        for (int i = 0; i < 3; i++)
+            Put<std::int32_t>(bytes, (std::int32_t)std::lround(pos[i] / LAS_SCALE));
+        Put<std::uint16_t>(bytes, 0);           // intensity
+        Put<std::uint8_t>(bytes, 0x11);         // return 1 / 1
+        Put<std::uint8_t>(bytes, 0);            // classification flags, channel, scan direction, edge
+        Put<std::uint8_t>(bytes, 0);            // classification (never classified)
+        Put<std::uint8_t>(bytes, 0);            // user data
+        Put<std::int16_t>(bytes, 0);            // scan angle
+        Put<std::uint16_t>(bytes, 0);           // point source id
+        Put<double>(bytes, p.time);             // GPS time ڸ  ð
+        Put<std::int32_t>(bytes, p.boxIndex);
+        Put<std::int8_t>(bytes, (std::int8_t)p.face);
+    }
+
+    fwrite(bytes.data(), 1, bytes.size(), file);
+    written.store(before + chunk.size());
+}
+
+void PointExporter::PatchHeader()
+{
+    std::uint64_t count = written.load();
+
+    if (format == PointExportFormat::Ply)
+    {
+        fseek(file, plyCountOffset, SEEK_SET);
+        fprintf(file, "%010llu", (unsigned long long)count);
+        return;
+    }
+
+    bytes.clear();
+    for (int i = 0; i < 3; i++)
+    {
+        Put<double>(bytes, bmax[i]);
+        Put<double>(bytes, bmin[i]);
+    }
+    fseek(file, LAS_BOUNDS_OFFSET, SEEK_SET);
+    fwrite(bytes.data(), 1, bytes.size(), file);
+
+    //   + return 1    (   ݻ)
+    bytes.clear();
+    Put<std::uint64_t>(bytes, count);
+    Put<std::uint64_t>(bytes, count);
+    fseek(file, LAS_POINT_COUNT_OFFSET, SEEK_SET);
+    fwrite(bytes.data(), 1, bytes.size(), file);
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#include <gl/glm/glm.hpp>
+
+// Ʈ Ŭ  
+enum class PointExportFormat
+{
+    Ply,    // binary_little_endian PLY (x y z time box face)
+    Las     // LAS 1.4,   6 + extra bytes (box, face)
+};
+
+//   ϳ
+struct ExportPoint
+{
+    glm::vec3 pos;
+    float time;         //  ð (). LAS  GPS time ڸ
+    int boxIndex;       //  ڽ (𸣸 -1)
+    int face;           //   (𸣸 -1)
+};
+
+//   ޾Ƽ ׶ 忡 Ϸ  
+//   /  ̸ 𸣴ϱ  ڸ Ƶΰ End ڿ ۾ 尡 ư ä
+//    MAX_PENDING  ޾Ƽ (CanAccept) Ŭ尡 Ŀ ޸𸮴    з 
+class PointExporter
+{
+public:
+    //  ϳ ִ   / ۾ 忡 ׾Ƶ  ִ  
+    static const std::size_t CHUNK_POINTS = 65536;
+    static const std::size_t MAX_PENDING = 2;
+
+    PointExporter() = default;
+    ~PointExporter();
+
+    PointExporter(const PointExporter&) = delete;
+    PointExporter& operator=(const PointExporter&) = delete;
+
+    //    ڸ .  Ⱑ   ̸   ٸ
+    bool Begin(const std::string& path, PointExportFormat format);
+
+    bool CanAccept();
+
+    void Submit(std::vector<ExportPoint>&& chunk);
+
+    //      ä    ˸ (ٸ )
+    void End();
+
+    // ݱ Ͽ   
+    std::uint64_t GetWrittenCount() const
+    {
+        return written.load();
+    }
+
+private:
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::vector<ExportPoint>> pending;
+    bool ending = false;
+
+    // ۾ 常 
+    FILE* file = nullptr;
+    PointExportFormat format = PointExportFormat::Ply;
+    double bmin[3] = { 0.0, 0.0, 0.0 };
+    double bmax[3] = { 0.0, 0.0, 0.0 };
+    std::vector<unsigned char> bytes;
+    long plyCountOffset = 0;        // PLY  "element vertex"  ڸ
+
+    std::atomic<std::uint64_t> written{ 0 };
+
+    void Join();
+    void Run();
+    void WriteHeader();
+    void WriteChunk(const std::vector<ExportPoint>& chunk);
+    void PatchHeader();
+};
@@ -0,0 +1,250 @@
+#include "RevealMask.h"
+
+RevealMaskPages::~RevealMaskPages()
+{
+    DeleteTextures();
+}
+
+void RevealMaskPages::DeleteTextures()
+{
+    if (!pages.empty())
+    {
+        glDeleteTextures((GLsizei)pages.size(), pages.data());
+        pages.clear();
+    }
+    if (blackTex != 0)
+    {
+        glDeleteTextures(1, &blackTex);
+        blackTex = 0;
+    }
+}
+
+void RevealMaskPages::Reset(int boxCount)
+{
+    DeleteTextures();
+
+    faceSlots.assign(boxCount * 6, -1);
+    slotOwners.clear();
+    slotLastUse.clear();
+    useClock = 0;
+
+    //  ĥ   ̰ 
+    unsigned char black = 0;
+    glGenTextures(1, &blackTex);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, blackTex);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R8, 1, 1, 1, 0, GL_RED, GL_UNSIGNED_BYTE, &black);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void RevealMaskPages::AddPage()
+{
+    GLuint tex = 0;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, tex);
+
+    //   ä.    RevealMaskCache::Clear  ̾ ° ø
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R8,
+        REVEAL_MASK_SIZE, REVEAL_MASK_SIZE, REVEAL_LAYERS_PER_PAGE,
+        0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    pages.push_back(tex);
+}
+
+int RevealMaskPages::AcquireFaceSlot(int boxIndex, int face, bool& fresh)
+{
+    fresh = false;
+
+    int key = boxIndex * 6 + face;
+    if (key < 0 || key >= (int)faceSlots.size())
+        return -1;
+
+    useClock++;
+
+    int slot = faceSlots[key];
+    if (slot >= 0)
+    {
+        slotLastUse[slot] = useClock;
+        return slot;
+    }
+
+    if ((int)slotOwners.size() < REVEAL_SLOT_BUDGET)
+    {
+        //     (ʿ   ø)
+        slot = (int)slotOwners.size();
+        if (PageOf(slot) >= (int)pages.size())
+        {
+            AddPage();
+        }
+
+        slotOwners.push_back(key);
+        slotLastUse.push_back(useClock);
+    }
+    else
+    {
+        //  á    ĥ  .    ٽ 
+        slot = 0;
+        for (int i = 1; i < (int)slotLastUse.size(); i++)
+        {
+            if (slotLastUse[i] < slotLastUse[slot])
+                slot = i;
+        }
+
+        faceSlots[slotOwners[slot]] = -1;
+        slotOwners[slot] = key;
+        slotLastUse[slot] = useClock;
+    }
+
+    faceSlots[key] = slot;
+    fresh = true;
+    return slot;
+}
+
+void RevealMaskCache::Clear(int slot)
+{
+    if (slot < 0)
+        return;
+
+    Entry& e = entries[slot];
+    if (!e.IsDirty())
+    {
+        dirtySlots.push_back(slot);
+    }
+
+    e.texels.assign(REVEAL_MASK_SIZE * REVEAL_MASK_SIZE, 0);
+
+    // GPU  ̾  ְų   ̶ °  
+    e.x0 = e.y0 = 0;
+    e.x1 = e.y1 = REVEAL_MASK_SIZE - 1;
+}
+
+void RevealMaskCache::Load(int slot, const unsigned char* texels)
+{
+    if (slot < 0)
+        return;
+
+    Entry& e = entries[slot];
+    if (!e.IsDirty())
+    {
+        dirtySlots.push_back(slot);
+    }
+
+    e.texels.assign(texels, texels + REVEAL_MASK_SIZE * REVEAL_MASK_SIZE);
+
+    e.x0 = e.y0 = 0;
+    e.x1 = e.y1 = REVEAL_MASK_SIZE - 1;
+}
+
+const unsigned char* RevealMaskCache::GetTexels(int slot) const
+{
+    auto it = entries.find(slot);
+    if (it == entries.end() || it->second.texels.empty())
+        return nullptr;
+
+    return it->second.texels.data();
+}
+
+void RevealMaskCache::Stamp(int slot, float u, float v, int R)
+{
+    if (slot < 0)
+        return;
+
+    const int LAST = REVEAL_MASK_SIZE - 1;
+
+    int X = int(u * LAST);
+    int Y = int(v * LAST);
+
+    //  ؽó  ġ   
+    if (X + R < 0 || X - R > LAST || Y + R < 0 || Y - R > LAST)
+        return;
+
+    Entry& e = entries[slot];
+    if (e.texels.empty())
+    {
+        e.texels.assign(REVEAL_MASK_SIZE * REVEAL_MASK_SIZE, 0);
+    }
+
+    if (!e.IsDirty())
+    {
+        dirtySlots.push_back(slot);
+    }
+
+    int minX = REVEAL_MASK_SIZE, minY = REVEAL_MASK_SIZE;
+    int maxX = -1, maxY = -1;
+
+    for (int j = -R; j <= R; j++)
+    {
+        int ty = Y + j;
+        if (ty < 0 || ty > LAST) continue;
+
+        for (int i = -R; i <= R; i++)
+        {
+            if (i * i + j * j > R * R) continue;
+
+            int tx = X + i;
+            if (tx < 0 || tx > LAST) continue;
+
+            e.texels[ty * REVEAL_MASK_SIZE + tx] = 255;
+
+            if (tx < minX) minX = tx;
+            if (tx > maxX) maxX = tx;
+            if (ty < minY) minY = ty;
+            if (ty > maxY) maxY = ty;
+        }
+    }
+
+    if (maxX < 0)
+        return;
+
+    if (minX < e.x0) e.x0 = minX;
+    if (minY < e.y0) e.y0 = minY;
+    if (maxX > e.x1) e.x1 = maxX;
+    if (maxY > e.y1) e.y1 = maxY;
+}
+
+void RevealMaskCache::Flush(const RevealMaskPages& pages)
+{
+    if (dirtySlots.empty())
+        return;
+
+    //    REVEAL_MASK_SIZE Ʈ 簢 Ϻθ ø  ROW_LENGTH  ˷ 
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, REVEAL_MASK_SIZE);
+
+    GLuint boundPage = 0;
+
+    for (int slot : dirtySlots)
+    {
+        Entry& e = entries[slot];
+        if (!e.IsDirty())
+            continue;
+
+        GLuint page = pages.GetSlotTexture(slot);
+        if (page != 0)
+        {
+            if (page != boundPage)
+            {
+                glBindTexture(GL_TEXTURE_2D_ARRAY, page);
+                boundPage = page;
+            }
+
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0,
+                e.x0, e.y0, RevealMaskPages::LayerOf(slot),
+                e.x1 - e.x0 + 1, e.y1 - e.y0 + 1, 1,
+                GL_RED, GL_UNSIGNED_BYTE,
+                &e.texels[e.y0 * REVEAL_MASK_SIZE + e.x0]);
+        }
+
+        e.x0 = e.y0 = REVEAL_MASK_SIZE;
+        e.x1 = e.y1 = -1;
+    }
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    dirtySlots.clear();
+}
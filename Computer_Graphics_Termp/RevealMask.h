@@ -0,0 +1,129 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <gl/glew.h>
+
+// revealMask     ũ (ؼ)
+const int REVEAL_MASK_SIZE = 256;
+
+// ؽó 迭    ũ 
+// GL 3.3  ϴ GL_MAX_ARRAY_TEXTURE_LAYERS ּҰ 256 ̶  ̻  
+const int REVEAL_LAYERS_PER_PAGE = 256;
+
+//  ũ   ִ ִ   (4  = 1024  = 64MB)
+//      ĥ    (LRU)
+const int REVEAL_SLOT_BUDGET = 4 * REVEAL_LAYERS_PER_PAGE;
+
+// 鸶  ؽó   GL_TEXTURE_2D_ARRAY   忡 ũ Ƴ
+//  = slot / 256, ̾ = slot % 256
+// ó    (-1)  " " ؽó , Lidar  ó ĥ   ޾ư
+// ڽ   ׸ϱ Map::Draw   ε    Ͼ
+class RevealMaskPages
+{
+public:
+    RevealMaskPages() = default;
+    ~RevealMaskPages();
+
+    RevealMaskPages(const RevealMaskPages&) = delete;
+    RevealMaskPages& operator=(const RevealMaskPages&) = delete;
+
+    //       ǵ (InitFromArray  ڽ   )
+    void Reset(int boxCount);
+
+    //   (  ĥų з -1)
+    int GetFaceSlot(int boxIndex, int face) const
+    {
+        int key = boxIndex * 6 + face;
+        return (key >= 0 && key < (int)faceSlots.size()) ? faceSlots[key] : -1;
+    }
+
+    // 鿡  ٿ (̹  ״). ֱ  ð 
+    // fresh  true   (Ȥ ٸ ׼ ) ̶  0   
+    int AcquireFaceSlot(int boxIndex, int face, bool& fresh);
+
+    int GetUsedSlotCount() const
+    {
+        return (int)slotOwners.size();
+    }
+
+    //   ִ  (ڽ * 6 + ),  -1
+    int GetSlotOwner(int slot) const
+    {
+        return (slot >= 0 && slot < (int)slotOwners.size()) ? slotOwners[slot] : -1;
+    }
+
+    static int PageOf(int slot)
+    {
+        return slot / REVEAL_LAYERS_PER_PAGE;
+    }
+
+    //    ؽó 0 ̾
+    static int LayerOf(int slot)
+    {
+        return slot >= 0 ? slot % REVEAL_LAYERS_PER_PAGE : 0;
+    }
+
+    //   ִ  ؽó.    ؽó
+    GLuint GetSlotTexture(int slot) const
+    {
+        if (slot < 0)
+            return blackTex;
+
+        int page = PageOf(slot);
+        return (page < (int)pages.size()) ? pages[page] : blackTex;
+    }
+
+private:
+    std::vector<int> faceSlots;             // (ڽ * 6 + ) -> 
+    std::vector<int> slotOwners;            //  -> (ڽ * 6 + )
+    std::vector<unsigned int> slotLastUse;  // Ը  ĥ ð
+    unsigned int useClock = 0;
+
+    std::vector<GLuint> pages;
+    GLuint blackTex = 0;                    // 1x1 ¥ 0 ̾ ϳ ( ĥ  )
+
+    void AddPage();
+    void DeleteTextures();
+};
+
+// revealMask Ը CPU  Ʈ ۸ ϳ  ִ ĳ
+// Ʈ  ۿ ⸸ ϰ, Flush  Ը  簢 ϳ glTexSubImage3D  ø
+// ( ؼ ϳ glTexSubImage2D  ҷ Ʈ ϳ ִ 113 ̹ ȣ )
+//    Clear  CPU ۸ 0   ̾ ü   ø
+class RevealMaskCache
+{
+public:
+    //   0  ( ޾Ұų ٸ ׼ Ѿ )
+    void Clear(int slot);
+
+    // (u, v)  ߽  radius  255  ĥ. ؽó  ߸
+    void Stamp(int slot, float u, float v, int radius);
+
+    //  Ͽ  ũ   °  (̾ ü ٽ ø)
+    void Load(int slot, const unsigned char* texels);
+
+    //  CPU  (REVEAL_MASK_SIZE * REVEAL_MASK_SIZE Ʈ).    ̸ nullptr
+    const unsigned char* GetTexels(int slot) const;
+
+    //  κи  ؽó ø. GL ȣ  GLUT 忡
+    void Flush(const RevealMaskPages& pages);
+
+private:
+    struct Entry
+    {
+        std::vector<unsigned char> texels;
+
+        //  簢 [x0, x1] x [y0, y1], x0 > x1 ̸ 
+        int x0 = REVEAL_MASK_SIZE, y0 = REVEAL_MASK_SIZE;
+        int x1 = -1, y1 = -1;
+
+        bool IsDirty() const
+        {
+            return x0 <= x1;
+        }
+    };
+
+    std::unordered_map<int, Entry> entries;
+    std::vector<int> dirtySlots;        // ̹ ӿ ĥ Ե (Flush  ̰͸ )
+};
@@ -0,0 +1,421 @@
+#include "ScanSave.h"
+
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    void AppendU32(std::vector<unsigned char>& bytes, std::uint32_t v)
+    {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(&v);
+        bytes.insert(bytes.end(), p, p + sizeof(v));
+    }
+
+    void AppendF32(std::vector<unsigned char>& bytes, float v)
+    {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(&v);
+        bytes.insert(bytes.end(), p, p + sizeof(v));
+    }
+
+    std::uint32_t ReadU32(const unsigned char* p)
+    {
+        std::uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    const std::size_t HEADER_SIZE = 4 * sizeof(std::uint32_t);
+    const std::size_t RECORD_HEADER_SIZE = 2 * sizeof(std::uint32_t);
+}
+
+void AppendSaveHeader(std::vector<unsigned char>& bytes, int boxCount, int maskSize)
+{
+    AppendU32(bytes, SCAN_SAVE_MAGIC);
+    AppendU32(bytes, SCAN_SAVE_VERSION);
+    AppendU32(bytes, (std::uint32_t)boxCount);
+    AppendU32(bytes, (std::uint32_t)maskSize);
+}
+
+void AppendSavePoints(std::vector<unsigned char>& bytes, const glm::vec3* points, std::size_t count)
+{
+    if (count == 0)
+        return;
+
+    AppendU32(bytes, SAVE_POINTS);
+    AppendU32(bytes, (std::uint32_t)(count * 3 * sizeof(float)));
+
+    // glm::vec3  float 3 پ ־ ° 
+    static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "glm::vec3 must be tightly packed");
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(points);
+    bytes.insert(bytes.end(), p, p + count * sizeof(glm::vec3));
+}
+
+void AppendSaveMask(std::vector<unsigned char>& bytes, int boxIndex, int face, const unsigned char* texels, int maskSize)
+{
+    AppendU32(bytes, SAVE_MASK);
+    AppendU32(bytes, (std::uint32_t)(2 * sizeof(std::uint32_t) + maskSize * maskSize));
+    AppendU32(bytes, (std::uint32_t)boxIndex);
+    AppendU32(bytes, (std::uint32_t)face);
+    bytes.insert(bytes.end(), texels, texels + maskSize * maskSize);
+}
+
+void AppendSaveState(std::vector<unsigned char>& bytes, float humanRevealScore, bool humanSoundPlayed)
+{
+    AppendU32(bytes, SAVE_STATE);
+    AppendU32(bytes, (std::uint32_t)(sizeof(float) + sizeof(std::uint32_t)));
+    AppendF32(bytes, humanRevealScore);
+    AppendU32(bytes, humanSoundPlayed ? 1u : 0u);
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::string& path)
+{
+    Close();
+
+    HANDLE f = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (f == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(f, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(f);
+        return false;
+    }
+
+    HANDLE m = CreateFileMappingA(f, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m == nullptr)
+    {
+        CloseHandle(f);
+        return false;
+    }
+
+    void* view = MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr)
+    {
+        CloseHandle(m);
+        CloseHandle(f);
+        return false;
+    }
+
+    fileHandle = f;
+    mappingHandle = m;
+    data = static_cast<const unsigned char*>(view);
+    size = (std::size_t)fileSize.QuadPart;
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (data != nullptr)
+        UnmapViewOfFile(data);
+    if (mappingHandle != nullptr)
+        CloseHandle(mappingHandle);
+    if (fileHandle != nullptr)
+        CloseHandle(fileHandle);
+
+    data = nullptr;
+    size = 0;
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+}
+
+#else
+
+bool MappedFile::Open(const std::string& path)
+{
+    Close();
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    void* view = mmap(nullptr, (std::size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED)
+        return false;
+
+    data = static_cast<const unsigned char*>(view);
+    size = (std::size_t)st.st_size;
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (data != nullptr)
+        munmap(const_cast<unsigned char*>(data), size);
+
+    data = nullptr;
+    size = 0;
+}
+
+#endif
+
+bool ScanSaveReader::Open(const std::string& path, int boxCount, int maskSize)
+{
+    Close();
+
+    if (!file.Open(path))
+        return false;
+
+    const unsigned char* p = file.Data();
+    if (file.Size() < HEADER_SIZE
+        || ReadU32(p) != SCAN_SAVE_MAGIC
+        || ReadU32(p + 4) != SCAN_SAVE_VERSION
+        || ReadU32(p + 8) != (std::uint32_t)boxCount
+        || ReadU32(p + 12) != (std::uint32_t)maskSize)
+    {
+        // ٸ  / ٸ    (ó )
+        file.Close();
+        return false;
+    }
+
+    cursor = HEADER_SIZE;
+    return true;
+}
+
+void ScanSaveReader::Close()
+{
+    file.Close();
+    cursor = 0;
+}
+
+bool ScanSaveReader::Next(Record& out)
+{
+    if (!IsOpen() || cursor + RECORD_HEADER_SIZE > file.Size())
+        return false;
+
+    const unsigned char* p = file.Data() + cursor;
+    std::uint32_t type = ReadU32(p);
+    std::uint32_t size = ReadU32(p + 4);
+
+    if (cursor + RECORD_HEADER_SIZE + size > file.Size())
+        return false;
+
+    out.type = type;
+    out.size = size;
+    out.payload = p + RECORD_HEADER_SIZE;
+
+    cursor += RECORD_HEADER_SIZE + size;
+    return true;
+}
+
+namespace
+{
+    // ũ  .    true
+    bool FlushAndClose(FILE* f)
+    {
+        bool ok = fflush(f) == 0;
+#ifdef _WIN32
+        ok = ok && _commit(_fileno(f)) == 0;
+#else
+        ok = ok && fsync(fileno(f)) == 0;
+#endif
+        ok = (fclose(f) == 0) && ok;
+        return ok;
+    }
+
+    // from  to ڸ ű (to   ). ̶ ߰ ° 
+    bool SwapInFile(const std::string& from, const std::string& to)
+    {
+#ifdef _WIN32
+        return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+        return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+    }
+}
+
+ScanSaveWriter::~ScanSaveWriter()
+{
+    Close();
+}
+
+void ScanSaveWriter::Start(const std::string& savePath)
+{
+    Close();
+
+    path = savePath;
+    stop = false;
+    thread = std::thread(&ScanSaveWriter::Run, this);
+}
+
+void ScanSaveWriter::Close()
+{
+    if (!thread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    cv.notify_all();
+    thread.join();
+}
+
+void ScanSaveWriter::Push(Job&& job)
+{
+    if (!thread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(std::move(job));
+    }
+    cv.notify_one();
+}
+
+void ScanSaveWriter::BeginRewrite(std::vector<unsigned char>&& bytes)
+{
+    Job job;
+    job.type = JOB_REWRITE_BEGIN;
+    job.bytes = std::move(bytes);
+    Push(std::move(job));
+}
+
+void ScanSaveWriter::RewritePart(std::vector<unsigned char>&& bytes)
+{
+    if (bytes.empty())
+        return;
+
+    Job job;
+    job.type = JOB_REWRITE_PART;
+    job.bytes = std::move(bytes);
+    Push(std::move(job));
+}
+
+void ScanSaveWriter::EndRewrite()
+{
+    Job job;
+    job.type = JOB_REWRITE_END;
+    Push(std::move(job));
+}
+
+void ScanSaveWriter::Append(std::vector<unsigned char>&& bytes)
+{
+    if (bytes.empty())
+        return;
+
+    Job job;
+    job.bytes = std::move(bytes);
+    Push(std::move(job));
+}
+
+void ScanSaveWriter::Run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        cv.wait(lock, [&] { return stop || !jobs.empty(); });
+
+        // stop ̾  ۾   (    Ȳ )
+        if (jobs.empty())
+            break;
+
+        Job job = std::move(jobs.front());
+        jobs.pop_front();
+
+        lock.unlock();
+        WriteJob(job);
+        lock.lock();
+    }
+
+    if (file != nullptr)
+    {
+        fclose(file);
+        file = nullptr;
+    }
+
+    // EndRewrite   ٽ   
+    if (tmpFile != nullptr)
+    {
+        fclose(tmpFile);
+        tmpFile = nullptr;
+        std::remove((path + ".tmp").c_str());
+    }
+}
+
+void ScanSaveWriter::WriteJob(const Job& job)
+{
+    std::string tmpPath = path + ".tmp";
+
+    switch (job.type)
+    {
+    case JOB_REWRITE_BEGIN:
+        //   ٲġ  ״  (ٰ    )
+        if (tmpFile != nullptr)
+            fclose(tmpFile);
+
+        tmpFile = fopen(tmpPath.c_str(), "wb");
+        rewriteOk = (tmpFile != nullptr);
+        if (rewriteOk)
+            rewriteOk = fwrite(job.bytes.data(), 1, job.bytes.size(), tmpFile) == job.bytes.size();
+        return;
+
+    case JOB_REWRITE_PART:
+        if (rewriteOk)
+            rewriteOk = fwrite(job.bytes.data(), 1, job.bytes.size(), tmpFile) == job.bytes.size();
+        return;
+
+    case JOB_REWRITE_END:
+    {
+        if (tmpFile == nullptr)
+            return;
+
+        // ũ     ٲġ (߰   ̵  ̵   )
+        // ϳ  (ũ   ) ӽ    Ͽ  
+        bool ok = FlushAndClose(tmpFile) && rewriteOk;
+        tmpFile = nullptr;
+
+        if (file != nullptr)
+        {
+            fclose(file);
+            file = nullptr;
+        }
+
+        if (!ok || !SwapInFile(tmpPath, path))
+            std::remove(tmpPath.c_str());
+
+        file = fopen(path.c_str(), "ab");
+        return;
+    }
+
+    case JOB_APPEND:
+        break;
+    }
+
+    if (file == nullptr)
+    {
+        file = fopen(path.c_str(), "ab");
+        if (file == nullptr)
+            return;
+    }
+
+    fwrite(job.bytes.data(), 1, job.bytes.size(), file);
+    fflush(file);
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#include <gl/glm/glm.hpp>
+
+// ĵ  Ȳ   (Ʈ / 麰 revealMask / human )
+//
+// [] magic, version, ڽ , ũ   ũ   (uint32 x 4)
+// [ڵ]* type, payload Ʈ , payload          (uint32, uint32, ...)
+//   SAVE_POINTS : float x, y, z ݺ
+//   SAVE_MASK   : uint32 ڽ, uint32 , ũ ؼ (size x size Ʈ)
+//   SAVE_STATE  : float humanRevealScore, uint32 humanSoundPlayed
+//
+// ÷ ߿   ͸ ڵ ڿ ̰,   ũ    ڿ   ̱
+// ҷⰡ      ִ   谡     ü  Ϸ ٽ Ἥ ()
+//   Ŀ ʰ 
+const std::uint32_t SCAN_SAVE_MAGIC = 0x5641534C;   // "LSAV"
+const std::uint32_t SCAN_SAVE_VERSION = 1;
+
+enum ScanSaveRecordType : std::uint32_t
+{
+    SAVE_POINTS = 1,
+    SAVE_MASK = 2,
+    SAVE_STATE = 3
+};
+
+// ڵ  (bytes ڿ )
+void AppendSaveHeader(std::vector<unsigned char>& bytes, int boxCount, int maskSize);
+void AppendSavePoints(std::vector<unsigned char>& bytes, const glm::vec3* points, std::size_t count);
+void AppendSaveMask(std::vector<unsigned char>& bytes, int boxIndex, int face, const unsigned char* texels, int maskSize);
+void AppendSaveState(std::vector<unsigned char>& bytes, float humanRevealScore, bool humanSoundPlayed);
+
+// б  ޸   (Windows: MapViewOfFile,  : mmap)
+//   θ ϰ  ũ б ϴ  ׶׶ Ͼ
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const std::string& path);
+    void Close();
+
+    const unsigned char* Data() const
+    {
+        return data;
+    }
+
+    std::size_t Size() const
+    {
+        return size;
+    }
+
+private:
+    const unsigned char* data = nullptr;
+    std::size_t size = 0;
+
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
+
+// ε   ڵ  ȱ
+class ScanSaveReader
+{
+public:
+    struct Record
+    {
+        std::uint32_t type = 0;
+        const unsigned char* payload = nullptr;
+        std::uint32_t size = 0;
+    };
+
+    //  ° ڽ  / ũ ũⰡ  ʰ   true
+    bool Open(const std::string& path, int boxCount, int maskSize);
+    void Close();
+
+    bool IsOpen() const
+    {
+        return file.Data() != nullptr;
+    }
+
+    //  ڵ. ̰ų ߸ ڵ(   ) false
+    bool Next(Record& out);
+
+private:
+    MappedFile file;
+    std::size_t cursor = 0;
+};
+
+//   ⸦ ׶  (GLUT  Ʈ ۸ ѱ ٷ ư)
+class ScanSaveWriter
+{
+public:
+    ScanSaveWriter() = default;
+    ~ScanSaveWriter();
+
+    ScanSaveWriter(const ScanSaveWriter&) = delete;
+    ScanSaveWriter& operator=(const ScanSaveWriter&) = delete;
+
+    void Start(const std::string& path);
+
+    //  ۾    
+    void Close();
+
+    bool IsOpen() const
+    {
+        return thread.joinable();
+    }
+
+    //  ü  . BeginRewrite () -> RewritePart   -> EndRewrite 
+    // ӽ Ͽ ̾ ٰ EndRewrite    ٲġ.   Append  θ  
+    // ߰ ϳ ϸ ӽ     ״ 
+    void BeginRewrite(std::vector<unsigned char>&& bytes);
+    void RewritePart(std::vector<unsigned char>&& bytes);
+    void EndRewrite();
+
+    //   
+    void Append(std::vector<unsigned char>&& bytes);
+
+private:
+    enum JobType
+    {
+        JOB_APPEND,
+        JOB_REWRITE_BEGIN,
+        JOB_REWRITE_PART,
+        JOB_REWRITE_END
+    };
+
+    struct Job
+    {
+        JobType type = JOB_APPEND;
+        std::vector<unsigned char> bytes;
+    };
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<Job> jobs;
+    bool stop = false;
+
+    std::string path;
+    FILE* file = nullptr;   // ۾ 常 
+    FILE* tmpFile = nullptr;    // ٽ   ӽ  (۾ 常)
+    bool rewriteOk = false;
+
+    void Push(Job&& job);
+    void Run();
+    void WriteJob(const Job& job);
+};
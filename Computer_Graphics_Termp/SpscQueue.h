@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+//   ϳ / Һ  ϳ   ũ  ť ( )
+// TryPush  ڸ, TryPop  Һڸ θ 
+// head  Һڸ, tail  ڸ    acquire  б⸸ ؼ ĭ   
+template <typename T>
+class SpscQueue
+{
+public:
+    //    ִ  capacity  ( ĭ ϳ   /   п)
+    explicit SpscQueue(std::size_t capacity)
+        : slots(capacity + 1)
+    {
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    //    false (item  ״)
+    bool TryPush(T&& item)
+    {
+        std::size_t t = tail.load(std::memory_order_relaxed);
+        std::size_t next = Next(t);
+        if (next == head.load(std::memory_order_acquire))
+            return false;
+
+        slots[t] = std::move(item);
+        tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    //   false
+    bool TryPop(T& out)
+    {
+        std::size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire))
+            return false;
+
+        out = std::move(slots[h]);
+        head.store(Next(h), std::memory_order_release);
+        return true;
+    }
+
+    //   忡      
+    bool Empty() const
+    {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+private:
+    std::vector<T> slots;
+
+    //  ٸ 尡  ̶ ĳ  
+    alignas(64) std::atomic<std::size_t> head{ 0 };
+    alignas(64) std::atomic<std::size_t> tail{ 0 };
+
+    std::size_t Next(std::size_t i) const
+    {
+        return (i + 1 == slots.size()) ? 0 : i + 1;
+    }
+};
@@ -1,3 +1,56 @@
 #include "TextureManager.h"
 
-std::unordered_map<std::string, GLuint> TextureManager::textures;
+std::unordered_map<std::string, int> TextureManager::layers;
+std::vector<std::vector<unsigned char>> TextureManager::images;
+GLuint TextureManager::arrayTex = 0;
+
+int TextureManager::Load(const std::string& name, const std::string& file)
+{
+    if (layers.find(name) != layers.end())
+        return layers[name];
+
+    // 迭    (BuildArray ڿ  ̹  迭 ° ٽ  )
+    if (arrayTex != 0)
+        return -1;
+
+    std::vector<unsigned char> image;
+    if (!LoadTextureImage(file.c_str(), ARRAY_SIZE, image))
+        return -1;
+
+    int layer = (int)images.size();
+    images.push_back(std::move(image));
+    layers[name] = layer;
+    return layer;
+}
+
+void TextureManager::BuildArray()
+{
+    if (images.empty())
+        return;
+
+    if (arrayTex == 0)
+        glGenTextures(1, &arrayTex);
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, arrayTex);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, ARRAY_SIZE, ARRAY_SIZE, (GLsizei)images.size(),
+        0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+    for (int layer = 0; layer < (int)images.size(); layer++)
+    {
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, ARRAY_SIZE, ARRAY_SIZE, 1,
+            GL_RGBA, GL_UNSIGNED_BYTE, images[layer].data());
+    }
+
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    // GPU  ÷ CPU  ʿ 
+    images.clear();
+    images.shrink_to_fit();
+}
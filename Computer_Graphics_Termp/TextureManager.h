@@ -1,39 +1,54 @@
 #pragma once
 #include <string>
+#include <vector>
 #include <unordered_map>
 #include <gl/glew.h>
 
-GLuint LoadTexture(const char* filename);
+// ̹  о size x size RGBA   (Ʒ , ϸ false)
+bool LoadTextureImage(const char* filename, int size, std::vector<unsigned char>& out);
 
+// ڽ  ؽó  GL_TEXTURE_2D_ARRAY ϳ ̾ 
+// Load  CPU  ؼ ׾Ƶα⸸ ϰ,  θ  BuildArray    ø
+//  ؽó ̸  ̾ ȣ  ־ ׸  ؽó ٲ   
 class TextureManager
 {
 public:
-    static std::unordered_map<std::string, GLuint> textures;
+    // 迭   ũ ( ũⰡ ̶   , uv  0~1 ̶ ̴  )
+    static const int ARRAY_SIZE = 512;
 
-    static GLuint Load(const std::string& name, const std::string& file)
-    {
-        if (textures.find(name) != textures.end())
-            return textures[name];
+    static std::unordered_map<std::string, int> layers;
+
+    // ̾ ȣ (̹   ȣ,   оų BuildArray ڸ -1)
+    static int Load(const std::string& name, const std::string& file);
+
+    // ׾Ƶ ̹ ؽó 迭  Ӹʱ  (CPU  ̹ )
+    static void BuildArray();
 
-        GLuint tex = LoadTexture(file.c_str());
-        textures[name] = tex;
-        return tex;
+    // ؽó ̾  ( -1)
+    static int Get(const std::string& name)
+    {
+        if (layers.find(name) == layers.end())
+            return -1;
+        return layers[name];
     }
 
-    // ؽó 
-    static GLuint Get(const std::string& name)
+    static GLuint GetArray()
     {
-        if (textures.find(name) == textures.end())
-            return 0;
-        return textures[name];
+        return arrayTex;
     }
 
     // ؽó  
     static void Clear()
     {
-        for (auto& kv : textures)
-            glDeleteTextures(1, &kv.second);
+        if (arrayTex != 0)
+            glDeleteTextures(1, &arrayTex);
 
-        textures.clear();
+        arrayTex = 0;
+        layers.clear();
+        images.clear();
     }
+
+private:
+    static GLuint arrayTex;
+    static std::vector<std::vector<unsigned char>> images;  // BuildArray  ̾ 
 };
@@ -0,0 +1,35 @@
+#include "VoxelHash.h"
+
+#include <cmath>
+
+std::uint64_t VoxelHash::KeyOf(const glm::vec3& p) const
+{
+    // ึ 21Ʈ (ȣ ִ  2^20 ŭ о)  . voxelSize 0.05  5 ֱ
+    const std::int64_t BIAS = 1 << 20;
+    const std::uint64_t MASK = (1u << 21) - 1;
+
+    std::uint64_t x = (std::uint64_t)((std::int64_t)std::floor(p.x / voxelSize) + BIAS) & MASK;
+    std::uint64_t y = (std::uint64_t)((std::int64_t)std::floor(p.y / voxelSize) + BIAS) & MASK;
+    std::uint64_t z = (std::uint64_t)((std::int64_t)std::floor(p.z / voxelSize) + BIAS) & MASK;
+
+    return (x << 42) | (y << 21) | z;
+}
+
+const VoxelHash::Voxel* VoxelHash::Find(const glm::vec3& p) const
+{
+    auto it = voxels.find(KeyOf(p));
+    if (it == voxels.end())
+        return nullptr;
+    return &it->second;
+}
+
+void VoxelHash::Prune(const std::function<bool(std::uint64_t)>& isAlive)
+{
+    for (auto it = voxels.begin(); it != voxels.end();)
+    {
+        if (!isAlive(it->second.pointHandle))
+            it = voxels.erase(it);
+        else
+            ++it;
+    }
+}
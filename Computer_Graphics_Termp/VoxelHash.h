@@ -0,0 +1,64 @@
+#pragma once
+
+#include <unordered_map>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+#include <gl/glm/glm.hpp>
+
+// ̴ Ʈ ߺ ſ  ؽ
+// ̹  ִ       װ   Ʈ  /   ġ 
+// ׷     Ⱦ Ŭ ũ ĵ Ƚ ƴ϶   
+//
+//  ڱ  PointCloud ڵ صΰ,
+// Ŭ尡   ̹ о (IsAlive == false)  ó ؼ ٽ  װ 
+class VoxelHash
+{
+public:
+    struct Voxel
+    {
+        std::uint64_t pointHandle = 0;  //    PointCloud ڵ
+        unsigned int hitCount = 0;      //   ִ   Ƚ
+        unsigned int lastSeen = 0;      //   ġ ȣ (Lidar::ApplyScanHits ȣ )
+    };
+
+    void SetVoxelSize(float size)
+    {
+        voxelSize = size;
+        Clear();
+    }
+
+    float GetVoxelSize() const
+    {
+        return voxelSize;
+    }
+
+    void Clear()
+    {
+        voxels.clear();
+    }
+
+    std::size_t Size() const
+    {
+        return voxels.size();
+    }
+
+    // p    ( hitCount 0   )
+    Voxel& Get(const glm::vec3& p)
+    {
+        return voxels[KeyOf(p)];
+    }
+
+    //  nullptr
+    const Voxel* Find(const glm::vec3& p) const;
+
+    //  ̹ з   (ؽð  Ŀ ʰ)
+    void Prune(const std::function<bool(std::uint64_t)>& isAlive);
+
+private:
+    float voxelSize = 0.05f;
+    std::unordered_map<std::uint64_t, Voxel> voxels;
+
+    std::uint64_t KeyOf(const glm::vec3& p) const;
+};
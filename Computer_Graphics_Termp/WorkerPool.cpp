@@ -0,0 +1,115 @@
+#include "WorkerPool.h"
+
+WorkerPool::~WorkerPool()
+{
+    StopWorkers();
+}
+
+void WorkerPool::StopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    wakeCv.notify_all();
+
+    for (std::thread& t : workers)
+    {
+        t.join();
+    }
+    workers.clear();
+
+    stop = false;
+}
+
+void WorkerPool::SetThreadCount(int count)
+{
+    if (count < 1)
+        count = 1;
+
+    if (count == GetThreadCount())
+        return;
+
+    StopWorkers();
+
+    for (int i = 0; i < count - 1; i++)
+    {
+        workers.emplace_back(&WorkerPool::WorkerLoop, this);
+    }
+}
+
+void WorkerPool::RunTasks(const std::function<void(int)>* task, int count)
+{
+    while (true)
+    {
+        int i = nextTask.fetch_add(1);
+        if (i >= count)
+            break;
+
+        (*task)(i);
+        pending.fetch_sub(1);
+    }
+}
+
+void WorkerPool::WorkerLoop()
+{
+    unsigned int seen = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        seen = generation;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        wakeCv.wait(lock, [&] { return stop || generation != seen; });
+        if (stop)
+            return;
+
+        seen = generation;
+        const std::function<void(int)>* task = job;
+        int count = jobCount;
+        activeWorkers++;
+
+        lock.unlock();
+        RunTasks(task, count);
+        lock.lock();
+
+        activeWorkers--;
+        if (activeWorkers == 0)
+            doneCv.notify_all();
+    }
+}
+
+void WorkerPool::ParallelFor(int taskCount, const std::function<void(int)>& task)
+{
+    if (taskCount <= 0)
+        return;
+
+    if (workers.empty() || taskCount == 1)
+    {
+        for (int i = 0; i < taskCount; i++)
+            task(i);
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        //  ϰ ʰ  ۾ڰ    ٷȴٰ  ϰ ø
+        doneCv.wait(lock, [&] { return activeWorkers == 0; });
+
+        job = &task;
+        jobCount = taskCount;
+        nextTask = 0;
+        pending = taskCount;
+        generation++;
+    }
+    wakeCv.notify_all();
+
+    RunTasks(&task, taskCount);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCv.wait(lock, [&] { return pending.load() == 0 && activeWorkers == 0; });
+    job = nullptr;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//  ۾  Ǯ
+// ParallelFor  [0, taskCount) ۾  , θ 嵵       ٸ
+//   1̸ 带   θ 忡  
+class WorkerPool
+{
+public:
+    WorkerPool() = default;
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // θ   ü   (1 ϸ 1)
+    void SetThreadCount(int count);
+
+    int GetThreadCount() const
+    {
+        return (int)workers.size() + 1;
+    }
+
+    //    忡 θ  (ø ȣ  )
+    void ParallelFor(int taskCount, const std::function<void(int)>& task);
+
+private:
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable wakeCv;
+    std::condition_variable doneCv;
+
+    bool stop = false;
+    unsigned int generation = 0;    // ParallelFor   , ۾ڴ ̰   ϰ 
+    int activeWorkers = 0;          //  ϰ  ִ ۾ 
+
+    const std::function<void(int)>* job = nullptr;
+    int jobCount = 0;
+    std::atomic<int> nextTask{ 0 };
+    std::atomic<int> pending{ 0 };
+
+    void WorkerLoop();
+    void RunTasks(const std::function<void(int)>* task, int count);
+    void StopWorkers();
+};
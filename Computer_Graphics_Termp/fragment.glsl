@@ -3,35 +3,52 @@
 in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoord;
+in float CaptureTime;
+
+flat in vec3 ObjectColor;   // objectColor / uHasTex / uTexRot / uFlipX / uRevealLayer / uTexLayer  vertex.glsl  (ڽ νϽ 鸶)
+flat in int HasTex;
+flat in int TexRot;
+flat in int FlipX;
+flat in int RevealLayer;
+flat in int TexLayer;
 
 out vec4 FragColor;
 
 uniform vec3 lightPos;
 uniform vec3 viewPos;
-uniform vec3 objectColor;
 uniform bool uDarkMode;
 
-uniform bool uHasTex;
-uniform sampler2D uTexture;
+uniform sampler2DArray uTexture;     //  ؽó  (TextureManager, 鸶 ̾ ϳ)
 
-uniform sampler2D uRevealMask;   // ؽó ִ 鸸 
+uniform sampler2DArray uRevealMask;   // ؽó ִ 鸸  (鸶 ̾ ϳ)
 
-uniform int  uTexRot;
-uniform bool uFlipX;
 uniform bool uIsScare;
 
+uniform float uTime;            // ̴   = uTime - CaptureTime
+uniform float uPointLifetime;   // 0 ̸   ( ׸  )
+
 void main()
 {
-    vec3 baseColor = objectColor;
+    vec3 baseColor = ObjectColor;
     vec2 uv = TexCoord;
 
+    //  ̴   οٰ   
+    float fade = 1.0;
+    if (uPointLifetime > 0.0)
+    {
+        fade = 1.0 - (uTime - CaptureTime) / uPointLifetime;
+        if (fade <= 0.0)
+            discard;
+        fade = min(fade, 1.0);
+    }
+
     if (uIsScare)
     {
-        vec3 baseColor = objectColor;
+        vec3 baseColor = ObjectColor;
 
-        if (uHasTex)
+        if (HasTex != 0)
         {
-            vec4 texColor = texture(uTexture, TexCoord);
+            vec4 texColor = texture(uTexture, vec3(TexCoord, float(TexLayer)));
             baseColor *= texColor.rgb;
         }
 
@@ -40,15 +57,15 @@ void main()
     }
 
     // ⺻ ؽó 
-    if (uHasTex)
+    if (HasTex != 0)
     {
-        if (uTexRot == 1)
+        if (TexRot == 1)
             uv = vec2(1.0 - uv.x, 1.0 - uv.y);
 
-        if (uFlipX)
+        if (FlipX != 0)
             uv.x = 1.0 - uv.x;
 
-        vec4 tex = texture(uTexture, uv);
+        vec4 tex = texture(uTexture, vec3(uv, float(TexLayer)));
         if (tex.a < 0.1)
             tex.rgb = vec3(0.1);
 
@@ -73,23 +90,23 @@ void main()
     if (uDarkMode)
     {
         //  ó ( /  / ĵ Ʈ)
-        if (objectColor == vec3(0.0,1.0,0.4) ||   // ĵ 
-            objectColor == vec3(0.25,0.25,0.25) ||// 
-            objectColor == vec3(1.0,0.0,0.0))     // 
+        if (ObjectColor == vec3(0.0,1.0,0.4) ||   // ĵ 
+            ObjectColor == vec3(0.25,0.25,0.25) ||// 
+            ObjectColor == vec3(1.0,0.0,0.0))     // 
         {
-            FragColor = vec4(lit, 1.0);
+            FragColor = vec4(lit * fade, 1.0);
             return;
         }
 
         // ؽó  ڽ revealMask  
-        if (!uHasTex)
+        if (HasTex == 0)
         {
             FragColor = vec4(0.0, 0.0, 0.0, 1.0);
             return;
         }
 
         // ؽó ִ ڽ revealMask 
-        float reveal = texture(uRevealMask, uv).r;
+        float reveal = texture(uRevealMask, vec3(uv, float(RevealLayer))).r;
 
           if (reveal < 0.01)
         {
@@ -103,5 +120,5 @@ void main()
         return;
     }
 
-    FragColor = vec4(lit, 1.0);
+    FragColor = vec4(lit * fade, 1.0);
 }
@@ -9,8 +9,8 @@ public:
     bool Load(const char* path);
     void Draw(GLuint shaderProgram,
         GLint uModelLoc,
-        GLint uViewLoc,
-        GLint uProjLoc,
+        GLint uNormalMatLoc,
+        GLint uViewProjLoc,
         GLint uColorLoc,
         const glm::mat4& view,
         const glm::mat4& proj,
@@ -5,6 +5,8 @@
 #include <fstream>
 #include <string>
 #include <vector>
+#include <algorithm>
+#include <thread>
 
 #include <gl/glew.h>
 #include <gl/freeglut.h>
@@ -52,8 +54,8 @@ GLuint VBO_cube = 0;
 GLuint EBO_cube = 0;
 
 GLint uModelLoc = -1;
-GLint uViewLoc = -1;
-GLint uProjLoc = -1;
+GLint uNormalMatLoc = -1;
+GLint uViewProjLoc = -1;
 GLint uColorLoc = -1;
 GLint uDarkModeLoc = -1;
 
@@ -62,7 +64,13 @@ GLint uFlipXLoc = -1;
 GLint uHasTexLoc = -1;
 GLint uTextureLoc = -1;
 GLint uRevealMaskLoc = -1;
+GLint uRevealLayerLoc = -1;
 GLint uIsScareLoc = -1;
+GLint uTimeLoc = -1;
+GLint uPointLifetimeLoc = -1;
+GLint uInstancedLoc = -1;
+GLint uMaterialLoc = -1;
+GLint uTexLayerLoc = -1;
 
 bool cull = false;
 bool wire_mode = false;
@@ -202,6 +210,7 @@ void main(int argc, char** argv)
             "digit_" + std::to_string(i) + ".png"
         );
     }
+    TextureManager::BuildArray();
     if (!AudioManager::Instance().Init())
     {
         std::cerr << "AudioManager ʱȭ \n";
@@ -251,7 +260,7 @@ void main(int argc, char** argv)
             boxIdx++,
             1
             });
-        bx[g_scareEvents.back().boxIndex].texID[g_scareEvents.back().targetFaceIndex] = TextureManager::Get("scary1");
+        bx[g_scareEvents.back().boxIndex].SetFaceTexture(g_scareEvents.back().targetFaceIndex, TextureManager::Get("scary1"));
     }
 
     if (boxIdx >= 0 && boxIdx < bx.size())
@@ -264,7 +273,7 @@ void main(int argc, char** argv)
             boxIdx++,
             1
             });
-        bx[g_scareEvents.back().boxIndex].texID[g_scareEvents.back().targetFaceIndex] = TextureManager::Get("scary2");
+        bx[g_scareEvents.back().boxIndex].SetFaceTexture(g_scareEvents.back().targetFaceIndex, TextureManager::Get("scary2"));
     }
 
     if (boxIdx >= 0 && boxIdx < bx.size())
@@ -277,7 +286,7 @@ void main(int argc, char** argv)
             boxIdx++,
             1
             });
-        bx[g_scareEvents.back().boxIndex].texID[g_scareEvents.back().targetFaceIndex] = TextureManager::Get("scary3");
+        bx[g_scareEvents.back().boxIndex].SetFaceTexture(g_scareEvents.back().targetFaceIndex, TextureManager::Get("scary3"));
     }
 
 
@@ -363,8 +372,8 @@ GLuint make_shaderProgram()
     glDeleteShader(fragmentShader);
 
     uModelLoc = glGetUniformLocation(prog, "uModel");
-    uViewLoc = glGetUniformLocation(prog, "uView");
-    uProjLoc = glGetUniformLocation(prog, "uProj");
+    uNormalMatLoc = glGetUniformLocation(prog, "uNormalMatrix");
+    uViewProjLoc = glGetUniformLocation(prog, "uViewProj");
     uColorLoc = glGetUniformLocation(prog, "objectColor");
     uDarkModeLoc = glGetUniformLocation(prog, "uDarkMode");
 
@@ -373,13 +382,20 @@ GLuint make_shaderProgram()
     uHasTexLoc = glGetUniformLocation(prog, "uHasTex");
     uTextureLoc = glGetUniformLocation(prog, "uTexture");
     uRevealMaskLoc = glGetUniformLocation(prog, "uRevealMask");
+    uRevealLayerLoc = glGetUniformLocation(prog, "uRevealLayer");
     uIsScareLoc = glGetUniformLocation(prog, "uIsScare");
+    uTimeLoc = glGetUniformLocation(prog, "uTime");
+    uPointLifetimeLoc = glGetUniformLocation(prog, "uPointLifetime");
+    uInstancedLoc = glGetUniformLocation(prog, "uInstanced");
+    uMaterialLoc = glGetUniformLocation(prog, "uMaterial");
+    uTexLayerLoc = glGetUniformLocation(prog, "uTexLayer");
 
     // 
     glUseProgram(prog);
     glUniform1i(uTextureLoc, 0);
     glUniform1i(uRevealMaskLoc, 1);
     glUniform1i(uIsScareLoc, 0);
+    glUniform1i(uInstancedLoc, 0);
 
 
     return prog;
@@ -539,7 +555,13 @@ GLvoid InitGL()
     }
 
     g_gun.Load("Gun.obj");
-    g_lidar.Init();
+    g_lidar.Init(g_map);
+    g_lidar.SetScanThreads((int)std::thread::hardware_concurrency());
+    g_lidar.SetPointDedup(true, 0.05f);   // 5cm   ϳ
+    g_lidar.SetPointLifetime(90.0f);      //  90    
+
+    //  ĵ  Ȳ (Ʈ / revealMask / human ). ù Ӻ ݾ о 
+    g_lidar.OpenSave("lidar_save.bin", g_map);
 
 
 }
@@ -554,29 +576,79 @@ void StartScanBeam()
     g_beam.tailTime = 0.05f;
 }
 
-GLuint LoadTexture(const char* filename)
+bool LoadTextureImage(const char* filename, int size, std::vector<unsigned char>& out)
 {
     int w, h, n;
     stbi_set_flip_vertically_on_load(true);
-    unsigned char* data = stbi_load(filename, &w, &h, &n, 0);
-    if (!data) return 0;
 
-    GLuint tex;
-    glGenTextures(1, &tex);
-    glBindTexture(GL_TEXTURE_2D, tex);
+    // RGB ̹  255  ä RGBA  
+    unsigned char* data = stbi_load(filename, &w, &h, &n, 4);
+    if (!data) return false;
+
+    out.assign((size_t)size * size * 4, 0);
+
+    // Ÿ ؼ ϳ     ( ),
+    //      ؼ ۾ϱ    ؼ    (ø )
+    float sx = (float)w / size;
+    float sy = (float)h / size;
 
-    GLenum format = (n == 4 ? GL_RGBA : GL_RGB);
+    for (int y = 0; y < size; y++)
+    {
+        for (int x = 0; x < size; x++)
+        {
+            float sum[4] = { 0, 0, 0, 0 };
+            float weight = 0.0f;
 
-    glTexImage2D(GL_TEXTURE_2D, 0, format, w, h, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
+            if (sx > 1.0f || sy > 1.0f)
+            {
+                int x0 = (int)(x * sx), x1 = std::max(x0 + 1, (int)((x + 1) * sx));
+                int y0 = (int)(y * sy), y1 = std::max(y0 + 1, (int)((y + 1) * sy));
+                x1 = std::min(x1, w);
+                y1 = std::min(y1, h);
+
+                for (int v = y0; v < y1; v++)
+                {
+                    for (int u = x0; u < x1; u++)
+                    {
+                        const unsigned char* p = data + ((size_t)v * w + u) * 4;
+                        for (int c = 0; c < 4; c++) sum[c] += p[c];
+                        weight += 1.0f;
+                    }
+                }
+            }
+            else
+            {
+                float fx = std::max((x + 0.5f) * sx - 0.5f, 0.0f);
+                float fy = std::max((y + 0.5f) * sy - 0.5f, 0.0f);
+                int u0 = std::min((int)fx, w - 1), u1 = std::min(u0 + 1, w - 1);
+                int v0 = std::min((int)fy, h - 1), v1 = std::min(v0 + 1, h - 1);
+                float tx = fx - u0, ty = fy - v0;
+
+                const int us[2] = { u0, u1 };
+                const int vs[2] = { v0, v1 };
+                const float wx[2] = { 1.0f - tx, tx };
+                const float wy[2] = { 1.0f - ty, ty };
+
+                for (int j = 0; j < 2; j++)
+                {
+                    for (int i = 0; i < 2; i++)
+                    {
+                        const unsigned char* p = data + ((size_t)vs[j] * w + us[i]) * 4;
+                        float k = wx[i] * wy[j];
+                        for (int c = 0; c < 4; c++) sum[c] += p[c] * k;
+                        weight += k;
+                    }
+                }
+            }
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            unsigned char* o = out.data() + ((size_t)y * size + x) * 4;
+            for (int c = 0; c < 4; c++)
+                o[c] = (unsigned char)std::min(255.0f, sum[c] / weight + 0.5f);
+        }
+    }
 
     stbi_image_free(data);
-    return tex;
+    return true;
 }
 
 void OpenDoor()
@@ -658,10 +730,15 @@ GLvoid drawScene()
     float aspect = static_cast<float>(width) / static_cast<float>(height);
     glm::mat4 proj = glm::perspective(glm::radians(60.0f), aspect, 0.1f, 200.0f);
 
-    g_map.Draw(shaderProgramID, VAO_cube, uModelLoc, uViewLoc, uProjLoc, uColorLoc, uTexRotLoc, uHasTexLoc, uTextureLoc, uRevealMaskLoc,uFlipXLoc, view, proj);
+    //     ĵ Ʈ ⼭   ݿ
+    g_lidar.SetClock(now * 0.001f);
+    g_lidar.ApplyScanHits(g_map);
 
-    g_lidar.Draw(shaderProgramID,
-        uModelLoc, uViewLoc, uProjLoc, uColorLoc,
+    g_map.Draw(shaderProgramID, VAO_cube, uModelLoc, uNormalMatLoc, uViewProjLoc, uColorLoc, uTexRotLoc, uHasTexLoc, uTextureLoc, uRevealMaskLoc, uRevealLayerLoc, uFlipXLoc, uTexLayerLoc, uInstancedLoc, uMaterialLoc, view, proj);
+
+    g_lidar.Draw(shaderProgramID, g_map,
+        uModelLoc, uNormalMatLoc, uViewProjLoc, uColorLoc,
+        uTimeLoc, uPointLifetimeLoc,
         view, proj);
 
     if (g_showDebugPoints)
@@ -669,9 +746,11 @@ GLvoid drawScene()
         glUseProgram(shaderProgramID);
         glDisable(GL_DEPTH_TEST);
         glm::mat4 model = glm::mat4(1.0f);
+        glm::mat3 normalMat = glm::mat3(1.0f);
+        glm::mat4 viewProj = proj * view;
         glUniformMatrix4fv(uModelLoc, 1, GL_FALSE, glm::value_ptr(model));
-        glUniformMatrix4fv(uViewLoc, 1, GL_FALSE, glm::value_ptr(view));
-        glUniformMatrix4fv(uProjLoc, 1, GL_FALSE, glm::value_ptr(proj));
+        glUniformMatrix3fv(uNormalMatLoc, 1, GL_FALSE, glm::value_ptr(normalMat));
+        glUniformMatrix4fv(uViewProjLoc, 1, GL_FALSE, glm::value_ptr(viewProj));
 
         glm::vec3 debugColor(1.0f, 0.0f, 0.0f);
         glUniform3fv(uColorLoc, 1, glm::value_ptr(debugColor));
@@ -695,7 +774,7 @@ GLvoid drawScene()
     glEnable(GL_DEPTH_TEST);
 
     g_gun.Draw(shaderProgramID,
-        uModelLoc, uViewLoc, uProjLoc, uColorLoc,
+        uModelLoc, uNormalMatLoc, uViewProjLoc, uColorLoc,
         view, proj,
         g_player.camPos,
         g_player.camFront,
@@ -714,7 +793,7 @@ GLvoid drawScene()
 
         if (boxIdx < 0 || boxIdx >= bx.size()) continue;
 
-        Box& scareBox = bx[boxIdx];
+        const Box& scareBox = bx[boxIdx];
 
         if (event.coolDownTimer > 0.0f) {
             event.coolDownTimer -= deltaTime;
@@ -726,31 +805,24 @@ GLvoid drawScene()
 
             if (isPlayerScanning)
             {
-                scareBox.size = glm::vec3(event.triggerRadius, event.triggerRadius, event.triggerRadius);
-                scareBox.pos = event.triggerPoint;
-
-                glm::vec3 hitPos;
-                int hitBox = -1;
-                int hitFace = -1;
-
-                if (g_lidar.Raycast(g_player.camPos,
-                    glm::normalize(g_player.camFront),
-                    g_map.GetBoxes(),
-                    100.0f, hitPos,
-                    &hitBox, &hitFace))
+                // Ʈ ڴ ʿ  ʰ ī޶ ̷   ׽Ʈ 
+                // ( ڽ ٲٸ BVH refit + ĵ  簡   Ͼ)
+                // ʿ   Ʈ տ  ߵ ( Ÿ  ̱)
+                glm::vec3 rayDir = glm::normalize(g_player.camFront);
+                glm::vec3 half = glm::vec3(event.triggerRadius * 0.5f);
+
+                float probeT = 0.0f;
+                int probeFace = -1;
+                if (IntersectBoxSlab(event.triggerPoint - half, event.triggerPoint + half,
+                    g_player.camPos, rayDir, 100.0f, probeT, probeFace))
                 {
-                    if (hitBox == boxIdx)
+                    if (!g_lidar.RaycastAny(g_player.camPos, rayDir, g_map, probeT))
                     {
                         g_scareActiveTimers[i] = SCARE_DURATION;
                         event.coolDownTimer = event.coolDownDuration;
                         std::cout << "[SCARE] Jumpscare HIT: " << event.textureName << " Triggered! Active Timer: " << SCARE_DURATION << std::endl;
                     }
                 }
-
-                if (hitBox != boxIdx) {
-                    scareBox.size = glm::vec3(0.0f, 0.0f, 0.0f);
-                    scareBox.pos = glm::vec3(0.0f, -9999.0f, 0.0f);
-                }
             }
         }
 
@@ -774,27 +846,30 @@ GLvoid drawScene()
                 glm::mat4 modelScare = glm::mat4(1.0f);
                 modelScare = glm::scale(modelScare, glm::vec3(2.0f, 2.0f, 1.0f));
 
-                glm::mat4 viewId = glm::mat4(1.0f);
-                glm::mat4 projId = glm::mat4(1.0f);
+                glm::mat3 normalScare = glm::transpose(glm::inverse(glm::mat3(modelScare)));
+                glm::mat4 viewProjId = glm::mat4(1.0f);
 
                 glUniformMatrix4fv(uModelLoc, 1, GL_FALSE, glm::value_ptr(modelScare));
-                glUniformMatrix4fv(uViewLoc, 1, GL_FALSE, glm::value_ptr(viewId));
-                glUniformMatrix4fv(uProjLoc, 1, GL_FALSE, glm::value_ptr(projId));
+                glUniformMatrix3fv(uNormalMatLoc, 1, GL_FALSE, glm::value_ptr(normalScare));
+                glUniformMatrix4fv(uViewProjLoc, 1, GL_FALSE, glm::value_ptr(viewProjId));
 
                 //   / ؽó ״ 
                 glUniform3fv(uColorLoc, 1, glm::value_ptr(scareBox.color));
 
                 glUniform1i(uTexRotLoc, 0);
                 glUniform1i(uFlipXLoc, 0);
-                glUniform1i(uHasTexLoc, 1);
+                glUniform1i(uHasTexLoc, scareBox.hasTex[1] ? 1 : 0);
 
                 glActiveTexture(GL_TEXTURE0);
-                glBindTexture(GL_TEXTURE_2D, scareBox.texID[1]);
+                glBindTexture(GL_TEXTURE_2D_ARRAY, TextureManager::GetArray());
                 glUniform1i(uTextureLoc, 0);
+                glUniform1i(uTexLayerLoc, scareBox.texLayer[1]);
 
+                int revealSlot = g_map.GetRevealPages().GetFaceSlot(boxIdx, 1);
                 glActiveTexture(GL_TEXTURE1);
-                glBindTexture(GL_TEXTURE_2D, scareBox.revealMask[1]);
+                glBindTexture(GL_TEXTURE_2D_ARRAY, g_map.GetRevealPages().GetSlotTexture(revealSlot));
                 glUniform1i(uRevealMaskLoc, 1);
+                glUniform1i(uRevealLayerLoc, RevealMaskPages::LayerOf(revealSlot));
 
                 // +Z (face=1) ׸
                 glDrawElements(
@@ -811,14 +886,9 @@ GLvoid drawScene()
 
                 glBindVertexArray(0);
             }
-            else
-            {
-                scareBox.pos = glm::vec3(0.0f, -9999.0f, 0.0f);
-                scareBox.size = glm::vec3(0.0f, 0.0f, 0.0f);
-            }
         }
     }
-    g_lidar.UpdateScan(deltaTime);
+    g_lidar.UpdateScan();
 
     if (g_beam.active)
     {
@@ -864,9 +934,11 @@ GLvoid drawScene()
         glm::vec3 endPos = start + camFront * g_beam.curLength;
 
         glm::mat4 modelBeam = glm::mat4(1.0f);
+        glm::mat3 normalBeam = glm::mat3(1.0f);
+        glm::mat4 viewProj = proj * view;
         glUniformMatrix4fv(uModelLoc, 1, GL_FALSE, glm::value_ptr(modelBeam));
-        glUniformMatrix4fv(uViewLoc, 1, GL_FALSE, glm::value_ptr(view));
-        glUniformMatrix4fv(uProjLoc, 1, GL_FALSE, glm::value_ptr(proj));
+        glUniformMatrix3fv(uNormalMatLoc, 1, GL_FALSE, glm::value_ptr(normalBeam));
+        glUniformMatrix4fv(uViewProjLoc, 1, GL_FALSE, glm::value_ptr(viewProj));
 
         glm::vec3 beamColor(1.0f, 0.0f, 0.0f);
         glUniform3fv(uColorLoc, 1, glm::value_ptr(beamColor));
@@ -945,11 +1017,14 @@ GLvoid drawScene()
             g_doorOpening = false;
             g_doorOpened = true;
         }
+
+        g_map.UpdateBoxBounds();
     }
 
     if (g_doorOpened && IsPlayerInExitZone())
     {
         std::cout << "GAME CLEAR\n";
+        g_lidar.CloseSave(g_map);
         glutLeaveMainLoop();
         return;
     }
@@ -985,9 +1060,22 @@ void KeyDown(unsigned char key, int x, int y)
         g_darkMode = !g_darkMode;
     }
 
+    // Ʈ Ŭ  (  ư  ڿ )
+    if (key == 'p')
+    {
+        if (g_lidar.ExportPoints("lidar_points.ply", PointExportFormat::Ply))
+            std::cout << "exporting lidar_points.ply (" << g_lidar.GetPointCount() << " points)\n";
+    }
+    if (key == 'o')
+    {
+        if (g_lidar.ExportPoints("lidar_points.las", PointExportFormat::Las))
+            std::cout << "exporting lidar_points.las (" << g_lidar.GetPointCount() << " points)\n";
+    }
+
     if (key == 27)
     {
         AudioManager::Instance().Release();
+        g_lidar.CloseSave(g_map);
         glutLeaveMainLoop();
     }
 
@@ -1009,19 +1097,16 @@ void MouseButton(int button, int state, int x, int y)
         glm::vec3 origin = g_player.camPos;
         glm::vec3 dir = glm::normalize(g_player.camFront);
 
-        const auto& bx = g_map.GetBoxes();
-
         int hit = -1;
 
-        for (int i = g_map.keypadStartIndex; i <= g_map.keypadEndIndex; i++)
+        //   ڽ Űе ư   ɷ ó ( ʸ Űе  )
+        glm::vec3 hp;
+        int hitBox = -1;
+        if (g_lidar.Raycast(origin, dir, g_map, 1000.0f, hp, &hitBox, nullptr))
         {
-            glm::vec3 hp;
-            int face = -1;
-
-            if (g_lidar.Raycast(origin, dir, { bx[i] }, 1000.0f, hp, nullptr, &face))
+            if (hitBox >= g_map.keypadStartIndex && hitBox <= g_map.keypadEndIndex)
             {
-                hit = i;
-                break;
+                hit = hitBox;
             }
         }
 
@@ -1041,7 +1126,7 @@ void MouseButton(int button, int state, int x, int y)
             g_player.camPos,
             g_player.camFront,
             g_player.camUp,
-            g_map.GetBoxes()
+            g_map
         );
         g_isFanBeam = false;
         StartScanBeam();
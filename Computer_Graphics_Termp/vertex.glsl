@@ -1,25 +1,97 @@
 #version 330 core
 
-layout(location = 0) in vec3 aPos;
+layout(location = 0) in vec3 aPos;      // ̴  ȭ [0, 1]  (uModel  ûũ  /  Ǯ)
 layout(location = 1) in vec3 aNormal;
 layout(location = 2) in vec2 aTexCoord;  
+layout(location = 3) in float aCaptureTime;  // ̴   ð (ٸ ü Ӽ  Ѽ 0)
+
+// ڽ νϽ (BoxInstanceBuffer, uInstanced   )
+layout(location = 4) in vec3 aInstPos;
+layout(location = 5) in vec3 aInstSize;
+layout(location = 6) in vec3 aInstColor;
+layout(location = 7) in uint aInstFaceFlags;        // 鸶 4Ʈ:  / ؽó / ȸ / 
+layout(location = 8) in uvec2 aInstRevealLayers;    // 鸶 8Ʈ
+layout(location = 9) in uvec2 aInstMaterials;       // 鸶 8Ʈ
+layout(location = 10) in uvec2 aInstTexLayers;      // 鸶 8Ʈ ( ؽó 迭 ̾)
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoord;       
+out float CaptureTime;
+
+// νϽ̸ 鸶, ƴϸ uniform  ״
+flat out vec3 ObjectColor;
+flat out int HasTex;
+flat out int TexRot;
+flat out int FlipX;
+flat out int RevealLayer;
+flat out int TexLayer;
 
 uniform mat4 uModel;
-uniform mat4 uView;
-uniform mat4 uProj;
+uniform mat3 uNormalMatrix;   // transpose(inverse(mat3(uModel)))  ü CPU    ؼ 
+uniform mat4 uViewProj;       // uProj * uView  CPU  ̸ ؼ 
+
+uniform vec3 objectColor;
+uniform bool uHasTex;
+uniform int  uTexRot;
+uniform bool uFlipX;
+uniform int  uRevealLayer;
+uniform int  uTexLayer;
+
+uniform bool uInstanced;
+uniform int  uMaterial;     // ̹ ׸  ٸ  
+
+//  0~3  x,  4~5  y  8Ʈ
+uint FaceByte(uvec2 packed, int face)
+{
+    uint word = (face < 4) ? packed.x : packed.y;
+    return (word >> uint((face % 4) * 8)) & 0xFFu;
+}
 
 void main()
 {
+    CaptureTime = aCaptureTime;
+    TexCoord = aTexCoord;
+
+    if (uInstanced)
+    {
+        // VAO_cube  鸶  4  ȣ  
+        int face = gl_VertexID / 4;
+        uint flags = (aInstFaceFlags >> uint(face * 4)) & 0xFu;
+
+        //  ̴  / ٸ    0 ﰢ   ׷
+        if ((flags & 1u) == 0u || int(FaceByte(aInstMaterials, face)) != uMaterial)
+        {
+            gl_Position = vec4(0.0);
+            return;
+        }
+
+        ObjectColor = aInstColor;
+        HasTex = int((flags >> 1) & 1u);
+        TexRot = int((flags >> 2) & 1u);
+        FlipX = int((flags >> 3) & 1u);
+        RevealLayer = int(FaceByte(aInstRevealLayers, face));
+        TexLayer = int(FaceByte(aInstTexLayers, face));
+
+        //   ڽ ũ⸸ ϸ ǰ  ⵵ ״
+        FragPos = aInstPos + aPos * aInstSize;
+        Normal = aNormal;
+
+        gl_Position = uViewProj * vec4(FragPos, 1.0);
+        return;
+    }
+
+    ObjectColor = objectColor;
+    HasTex = uHasTex ? 1 : 0;
+    TexRot = uTexRot;
+    FlipX = uFlipX ? 1 : 0;
+    RevealLayer = uRevealLayer;
+    TexLayer = uTexLayer;
+
     vec4 worldPos = uModel * vec4(aPos, 1.0);
     FragPos = worldPos.xyz;
 
-    Normal = mat3(transpose(inverse(uModel))) * aNormal;
-    
-    TexCoord = aTexCoord;      
+    Normal = uNormalMatrix * aNormal;
 
-    gl_Position = uProj * uView * worldPos;
+    gl_Position = uViewProj * worldPos;
 }